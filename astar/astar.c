@@ -0,0 +1,305 @@
+#include "astar.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+// Util functions
+// Distance between neighbouring cells
+// 14 is roughly sqrt(2) - diagonal
+// 10 is adjacent squares
+Cost_Typedef compute_distance(int x1, int y1, int x2, int y2) {
+    Cost_Typedef dx = abs(x1 - x2);
+    Cost_Typedef dy = abs(y1 - y2);
+    if (dx > dy) return 14 * dy + 10 * (dx - dy);
+    return 14 * dx + 10 * (dy - dx);
+}
+
+// Number of cells in the searched map
+static size_t cell_count(const AStarContext_Typedef* ctx) {
+    return (size_t)ctx->map->width * ctx->map->height;
+}
+
+bool astar_create(AStarContext_Typedef* ctx, const Map_Typedef* map) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->map = map;
+    size_t count = cell_count(ctx);
+    if (count > INT32_MAX) return false;
+    ctx->g_cost = malloc(count * sizeof(*ctx->g_cost));
+    ctx->parent = malloc(count * sizeof(*ctx->parent));
+    ctx->state = malloc(count * sizeof(*ctx->state));
+    ctx->stamp = calloc(count, sizeof(*ctx->stamp));
+    if (!ctx->g_cost || !ctx->parent || !ctx->state || !ctx->stamp ||
+        !queue_create(&ctx->open_nodes_queue, (int)count)) {
+        astar_destroy(ctx);
+        return false;
+    }
+#if !INTEGER_COSTS
+    ctx->open_nodes_queue.tie_break = ctx->g_cost;
+#endif
+    // Zeroed stamps must be stale, so a context that hasn't searched yet
+    // shows every cell empty (2 is also where next_generation restarts)
+    ctx->generation = 2;
+    ctx->status = SEARCH_NO_PATH;
+    return true;
+}
+
+void astar_destroy(AStarContext_Typedef* ctx) {
+    free(ctx->g_cost);
+    free(ctx->parent);
+    free(ctx->state);
+    free(ctx->stamp);
+    queue_destroy(&ctx->open_nodes_queue);
+    free(ctx->g_cost_back);
+    free(ctx->parent_back);
+    free(ctx->stamp_back);
+    queue_destroy(&ctx->back_queue);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int32_t astar_cell_id(const AStarContext_Typedef* ctx, int x, int y) {
+    return y * ctx->map->width + x;
+}
+
+CellPosition_Typedef astar_cell_position(const AStarContext_Typedef* ctx,
+                                         int32_t id) {
+    CellPosition_Typedef position = {.x = id % ctx->map->width,
+                                     .y = id / ctx->map->width};
+    return position;
+}
+
+CellState_Typedef astar_cell_state(const AStarContext_Typedef* ctx, int x,
+                                   int y) {
+    if (map_is_barrier(ctx->map, x, y)) return CELL_BARRIER;
+    int32_t id = astar_cell_id(ctx, x, y);
+    bool seen = is_seen(ctx, id) ||
+                (ctx->stamp_back && ctx->stamp_back[id] - ctx->generation <= 1);
+    return seen ? ctx->state[id] : CELL_EMPTY;
+}
+
+void next_generation(AStarContext_Typedef* ctx) {
+    // Moving to a new generation makes every stamp stale. Stamps are only
+    // cleared when the generation wraps around
+    ctx->generation += 2;
+    if (ctx->generation == 0 || ctx->generation == UINT32_MAX) {
+        memset(ctx->stamp, 0, cell_count(ctx) * sizeof(*ctx->stamp));
+        if (ctx->stamp_back) {
+            memset(ctx->stamp_back, 0,
+                   cell_count(ctx) * sizeof(*ctx->stamp_back));
+        }
+        ctx->generation = 2;
+    }
+    queue_clear(&ctx->open_nodes_queue);
+}
+
+bool astar_begin(AStarContext_Typedef* ctx, CellPosition_Typedef start,
+                 CellPosition_Typedef target) {
+    ctx->status = SEARCH_NO_PATH;
+    ctx->expanded_count = 0;  // Also for queries rejected below
+    if (map_is_barrier(ctx->map, start.x, start.y) ||
+        map_is_barrier(ctx->map, target.x, target.y)) {
+        return false;  // Off the map or blocked
+    }
+    if (ctx->mode == EXPAND_JPS_PLUS &&
+        (!ctx->jump_table || ctx->jump_table->map != ctx->map)) {
+        return false;  // No jump distances for this map
+    }
+    if (ctx->landmarks && ctx->landmarks->map != ctx->map) {
+        return false;  // Landmark distances of another map
+    }
+    if (ctx->components && ctx->components->map != ctx->map) {
+        return false;  // Components of another map
+    }
+
+    // Forget the previous search, which clears every cell on screen
+    next_generation(ctx);
+    if (ctx->changes) ctx->changes->overflowed = true;
+    ctx->start = start;
+    ctx->target = target;
+
+    // Start cell
+    int32_t start_id = astar_cell_id(ctx, start.x, start.y);
+    set_seen(ctx, start_id);
+    set_state(ctx, start_id, CELL_START);
+    ctx->g_cost[start_id] = 0;
+    ctx->parent[start_id] = -1;
+
+    // End cell
+    int32_t target_id = astar_cell_id(ctx, target.x, target.y);
+    set_seen(ctx, target_id);
+    set_state(ctx, target_id, CELL_TARGET);
+    if (target_id != start_id) {
+        ctx->g_cost[target_id] = COST_MAX;  // Not reached yet
+        ctx->parent[target_id] = -1;
+    }
+
+    if (start.x == target.x && start.y == target.y) {
+        ctx->status = SEARCH_FOUND;
+        return true;
+    }
+    if (ctx->components &&
+        !components_connected(ctx->components, start.x, start.y, target.x,
+                              target.y)) {
+        return true;  // Walled off, SEARCH_NO_PATH without a single step
+    }
+
+    // The bidirectional search queues the start and the target itself
+    bool queued = ctx->mode == EXPAND_BIDIRECTIONAL
+                      ? bidirectional_begin(ctx)
+                      : queue_push(&ctx->open_nodes_queue, start_id,
+                                   h(ctx, start.x, start.y));
+    if (!queued) {
+        ctx->status = SEARCH_FAILED;  // Out of memory
+        return false;
+    }
+    ctx->status = SEARCH_RUNNING;
+    return true;
+}
+
+// A*, queue every open neighbour of an evaluated cell
+static void astar_expand(AStarContext_Typedef* ctx, int32_t current) {
+    // Get the x and y position of the current cell
+    const Map_Typedef* map = ctx->map;
+    int x = current % map->width, y = current / map->width;
+    int32_t target = astar_cell_id(ctx, ctx->target.x, ctx->target.y);
+
+    // Assess each of the 8 neighbours around the current cell
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        // Get a neighbour
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (nx < 0 || nx >= map->width || ny < 0 || ny >= map->height) {
+            continue;  // Skip out of bounds neighbours
+        }
+        int32_t neighbour = current + neighbour_dy[n] * map->width +
+                            neighbour_dx[n];
+        Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+
+        // Check if the neighbour is the target (it is next to the cheapest
+        // open cell, so the heuristic is exact and this route is optimal)
+        if (neighbour == target) {
+            ctx->g_cost[neighbour] = ctx->g_cost[current] + step;
+            ctx->parent[neighbour] = current;
+            ctx->status = SEARCH_FOUND;
+            return;
+        }
+
+        // Check if the neighbour is a barrier
+        if (map->barriers[neighbour]) {
+            continue;
+        }
+
+        // Queue the neighbour if it is new to this search or this route
+        // lowers its g-cost (distance from the start)
+        open_cell(ctx, neighbour, current, ctx->g_cost[current] + step, nx,
+                  ny);
+    }
+}
+
+SearchStatus_Typedef astar_step(AStarContext_Typedef* ctx) {
+    int32_t current;
+
+    // Stop if already found target (or gave up)
+    if (ctx->status != SEARCH_RUNNING) {
+        return ctx->status;
+    }
+    if (ctx->mode == EXPAND_BIDIRECTIONAL) {
+        return bidirectional_step(ctx);
+    }
+
+    // Get the current cell (lowest f-score off the queue)
+    if (!queue_pop(&ctx->open_nodes_queue, &current)) {
+        ctx->status = SEARCH_NO_PATH;
+        return ctx->status;
+    }
+
+    ctx->expanded_count++;
+
+    // Add current node to the set of closed nodes
+    set_closed(ctx, current);
+
+    // Set the current cell colour to a travelled cell colour
+    if (ctx->state[current] != CELL_START) {
+        set_state(ctx, current, CELL_VISITED);
+    }
+
+    switch (ctx->mode) {
+        case EXPAND_JPS:
+            jps_expand(ctx, current);
+            break;
+        case EXPAND_JPS_PLUS:
+            jps_plus_expand(ctx, current);
+            break;
+        default:
+            astar_expand(ctx, current);
+            break;
+    }
+    return ctx->status;
+}
+
+SearchStatus_Typedef astar_run(AStarContext_Typedef* ctx, int max_expansions) {
+    for (int n = 0; max_expansions <= 0 || n < max_expansions; n++) {
+        if (astar_step(ctx) != SEARCH_RUNNING) break;
+    }
+    return ctx->status;
+}
+
+int astar_path_length(const AStarContext_Typedef* ctx) {
+    if (ctx->status != SEARCH_FOUND) return 0;
+    int length = 0;
+    int32_t id = astar_cell_id(ctx, ctx->target.x, ctx->target.y);
+    for (; id != -1; id = ctx->parent[id]) length++;
+    return length;
+}
+
+// Follow the parents back from the target, filling cells from the end so
+// the path comes out in start to target order
+static void fill_path(const AStarContext_Typedef* ctx,
+                      CellPosition_Typedef* cells, int length) {
+    int32_t id = astar_cell_id(ctx, ctx->target.x, ctx->target.y);
+    for (int i = length - 1; i >= 0; i--) {
+        cells[i] = astar_cell_position(ctx, id);
+        id = ctx->parent[id];
+    }
+}
+
+int astar_copy_path(const AStarContext_Typedef* ctx,
+                    CellPosition_Typedef* cells, int capacity) {
+    int length = astar_path_length(ctx);
+    if (length == 0 || length > capacity) return 0;
+    fill_path(ctx, cells, length);
+    return length;
+}
+
+bool astar_get_path(const AStarContext_Typedef* ctx, Path_Typedef* out_path) {
+    int length = astar_path_length(ctx);
+    if (length == 0) return false;
+    if (length > out_path->capacity) {
+        CellPosition_Typedef* cells =
+            realloc(out_path->cells, (size_t)length * sizeof(*cells));
+        if (!cells) return false;
+        out_path->cells = cells;
+        out_path->capacity = length;
+    }
+    fill_path(ctx, out_path->cells, length);
+    out_path->length = length;
+    return true;
+}
+
+void astar_free_path(Path_Typedef* path) {
+    free(path->cells);
+    path->cells = NULL;
+    path->length = 0;
+    path->capacity = 0;
+}
+
+bool astar_find_path(AStarContext_Typedef* ctx, CellPosition_Typedef start,
+                     CellPosition_Typedef target, Path_Typedef* out_path) {
+    if (!astar_begin(ctx, start, target)) return false;
+    if (astar_run(ctx, 0) != SEARCH_FOUND) return false;
+    return out_path ? astar_get_path(ctx, out_path) : true;
+}
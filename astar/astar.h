@@ -0,0 +1,163 @@
+#ifndef ASTAR_H
+#define ASTAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "components.h"
+#include "cost.h"
+#include "jump_table.h"
+#include "landmarks.h"
+#include "map.h"
+#include "queue.h"
+
+// A* Constants
+// (Theoretical) Number of neighbours around each cell
+#define NEIGHBOURS_COUNT 8
+
+// Cell state
+typedef enum {
+    CELL_EMPTY,
+    CELL_START,
+    CELL_BARRIER,
+    CELL_VISITED,
+    CELL_NEIGHBOUR,
+    CELL_PATH,
+    CELL_TARGET
+} CellState_Typedef;
+
+// Position of a cell
+typedef struct {
+    int x;
+    int y;
+} CellPosition_Typedef;
+
+// Progress of a search
+typedef enum {
+    SEARCH_RUNNING,
+    SEARCH_FOUND,
+    SEARCH_NO_PATH,
+    SEARCH_FAILED  // Ran out of memory, whether there is a path is unknown
+} SearchStatus_Typedef;
+
+// How a search explores the map
+typedef enum {
+    EXPAND_ASTAR,         // Queue every open neighbour
+    EXPAND_JPS,           // Jump Point Search, queue only the jump points
+    EXPAND_JPS_PLUS,      // JPS reading run lengths from ctx->jump_table
+    EXPAND_BIDIRECTIONAL  // A* from both ends until the two searches meet
+} ExpandMode_Typedef;
+
+// Cells from the start to the target (both included)
+typedef struct {
+    CellPosition_Typedef* cells;  // Grown as needed, free with astar_free_path
+    int length;
+    int capacity;
+} Path_Typedef;
+
+// Cells whose display state changed, recorded for a viewer that redraws
+// only those. The viewer owns the cells and empties the list once drawn
+typedef struct {
+    int32_t* cells;  // Cell ids, a cell may appear more than once
+    int count;
+    int capacity;
+    // More changes than fit, or a new search that cleared every cell: redraw
+    // the whole map
+    bool overflowed;
+} StateChanges_Typedef;
+
+// Everything a search works on, one per concurrent search
+typedef struct {
+    // Barriers being searched around (not owned)
+    const Map_Typedef* map;
+    // Search state for each cell, indexed by cell id (y * width + x). Only
+    // valid for cells whose stamp is from the current search (see generation)
+    Cost_Typedef* g_cost;  // Distance from the start
+    int32_t* parent;       // Cell id the cell was reached from, -1 at the start
+    uint8_t* state;        // CellState_Typedef, for display
+    uint32_t* stamp;       // Generation the cell was last touched in
+    // Current search, a stamp equal to it marks a cell seen by this search
+    // and generation + 1 an already evaluated (closed) cell. Older stamps are
+    // stale, so starting a new search costs nothing per cell
+    uint32_t generation;
+    // Nodes to be evaluated (queue)
+    Queue_Typedef open_nodes_queue;
+    CellPosition_Typedef start;
+    CellPosition_Typedef target;
+    SearchStatus_Typedef status;
+    ExpandMode_Typedef mode;  // Set before astar_begin, EXPAND_ASTAR by default
+    // Jump distances of the map for EXPAND_JPS_PLUS (not owned)
+    const JumpTable_Typedef* jump_table;
+    // Landmark distances of the map (not owned). When set the heuristic also
+    // uses the ALT bound, which sees around walls the octile distance ignores
+    const LandmarkTable_Typedef* landmarks;
+    // Connected components of the map (not owned). When set a target the
+    // start can't reach ends the search in astar_begin, without exploring
+    const Components_Typedef* components;
+    int expanded_count;  // Cells taken off the open queue this search
+    // Where to record display state changes (not owned), NULL by default
+    StateChanges_Typedef* changes;
+    // Backward search from the target for EXPAND_BIDIRECTIONAL, allocated by
+    // the first such search. Same layout as the forward state above
+    Cost_Typedef* g_cost_back;  // Distance to the target
+    int32_t* parent_back;       // Cell id towards the target, -1 at the target
+    uint32_t* stamp_back;
+    Queue_Typedef back_queue;
+    int32_t meeting;         // Cell on the cheapest path found so far, or -1
+    Cost_Typedef best_cost;  // Cost of that path, COST_MAX if none yet
+} AStarContext_Typedef;
+
+// Allocate the search state for a map. The map must outlive the context and
+// may be shared (read-only) between contexts
+bool astar_create(AStarContext_Typedef* ctx, const Map_Typedef* map);
+
+// Free the search state of a context
+void astar_destroy(AStarContext_Typedef* ctx);
+
+// Cell id of a position (must be on the map)
+int32_t astar_cell_id(const AStarContext_Typedef* ctx, int x, int y);
+
+// Position of a cell id
+CellPosition_Typedef astar_cell_position(const AStarContext_Typedef* ctx,
+                                         int32_t id);
+
+// State of a cell for display (barriers come from the map)
+CellState_Typedef astar_cell_state(const AStarContext_Typedef* ctx, int x,
+                                   int y);
+
+// Start a new search (any previous search is cleared)
+bool astar_begin(AStarContext_Typedef* ctx, CellPosition_Typedef start,
+                 CellPosition_Typedef target);
+
+// Expand the cheapest open cell, returns the state of the search
+SearchStatus_Typedef astar_step(AStarContext_Typedef* ctx);
+
+// Expand up to max_expansions cells (or until the search ends when
+// max_expansions <= 0), returns the state of the search
+SearchStatus_Typedef astar_run(AStarContext_Typedef* ctx, int max_expansions);
+
+// Run a whole search and, if the target is reachable, copy the path into
+// out_path (out_path may be NULL)
+bool astar_find_path(AStarContext_Typedef* ctx, CellPosition_Typedef start,
+                     CellPosition_Typedef target, Path_Typedef* out_path);
+
+// Number of cells on the path of a successful search (start and target
+// included), 0 if the search hasn't found one
+int astar_path_length(const AStarContext_Typedef* ctx);
+
+// Write the path of a successful search into cells (start first), which must
+// hold astar_path_length cells. Returns the number of cells written, 0 if
+// there is no path or it doesn't fit
+int astar_copy_path(const AStarContext_Typedef* ctx,
+                    CellPosition_Typedef* cells, int capacity);
+
+// Copy the path of a successful search into out_path, growing it to fit
+bool astar_get_path(const AStarContext_Typedef* ctx, Path_Typedef* out_path);
+
+// Free the cells of a path
+void astar_free_path(Path_Typedef* path);
+
+// Octile distance between two cells (10 straight, 14 diagonal)
+Cost_Typedef compute_distance(int x1, int y1, int x2, int y2);
+
+#endif  // ASTAR_H
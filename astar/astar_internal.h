@@ -0,0 +1,125 @@
+#ifndef ASTAR_INTERNAL_H
+#define ASTAR_INTERNAL_H
+
+// Helpers shared by the expansion modes, not part of the public API
+
+#include <stddef.h>
+
+#include "astar.h"
+
+// Generation stamp actions
+// Check if a cell has been seen (queued or evaluated) by the current search
+static inline bool is_seen(const AStarContext_Typedef* ctx, int32_t id) {
+    return ctx->stamp[id] - ctx->generation <= 1;
+}
+// Check if a cell has already been evaluated
+static inline bool is_closed(const AStarContext_Typedef* ctx, int32_t id) {
+    return ctx->stamp[id] == ctx->generation + 1;
+}
+// Mark a cell as seen, its g-cost, parent and state are now current
+static inline void set_seen(AStarContext_Typedef* ctx, int32_t id) {
+    ctx->stamp[id] = ctx->generation;
+}
+// Mark a cell as evaluated
+static inline void set_closed(AStarContext_Typedef* ctx, int32_t id) {
+    ctx->stamp[id] = ctx->generation + 1;
+}
+
+// Set the display state of a cell, recording the change if asked to
+static inline void set_state(AStarContext_Typedef* ctx, int32_t id,
+                             CellState_Typedef state) {
+    ctx->state[id] = state;
+    StateChanges_Typedef* changes = ctx->changes;
+    if (!changes) return;
+    if (changes->count < changes->capacity) {
+        changes->cells[changes->count++] = id;
+    } else {
+        changes->overflowed = true;
+    }
+}
+
+// Check if a cell can't be entered (out of bounds cells count as barriers)
+static inline bool blocked(const Map_Typedef* map, int x, int y) {
+    if (x < 0 || x >= map->width || y < 0 || y >= map->height) return true;
+    return map->barriers[(size_t)y * map->width + x] != 0;
+}
+
+// Check if a cell entered moving in direction (dx, dy) has a forced
+// neighbour, one that is only reached optimally through it because a
+// barrier beside the run blocks the symmetric route. Diagonal moves may cut
+// corners, as in astar_step
+static inline bool has_forced_neighbour(const Map_Typedef* map, int x, int y,
+                                        int dx, int dy) {
+    if (dx && dy) {
+        return (blocked(map, x - dx, y) && !blocked(map, x - dx, y + dy)) ||
+               (blocked(map, x, y - dy) && !blocked(map, x + dx, y - dy));
+    }
+    if (dx) {
+        return (blocked(map, x, y + 1) && !blocked(map, x + dx, y + 1)) ||
+               (blocked(map, x, y - 1) && !blocked(map, x + dx, y - 1));
+    }
+    return (blocked(map, x + 1, y) && !blocked(map, x + 1, y + dy)) ||
+           (blocked(map, x - 1, y) && !blocked(map, x - 1, y + dy));
+}
+
+// Forget the previous search: make every stamp stale and empty the open queue
+// (astar.c)
+void next_generation(AStarContext_Typedef* ctx);
+
+// Distance from target to some cell
+static inline Cost_Typedef h(const AStarContext_Typedef* ctx, int x1,
+                             int y1) {
+    Cost_Typedef distance =
+        compute_distance(x1, y1, ctx->target.x, ctx->target.y);
+    if (ctx->landmarks) {
+        int width = ctx->map->width;
+        Cost_Typedef bound = landmarks_bound(
+            ctx->landmarks, y1 * width + x1,
+            ctx->target.y * width + ctx->target.x);
+        if (bound > distance) distance = bound;
+    }
+    return distance;
+}
+
+// Check if the heuristic may be inconsistent (coarsened landmark distances,
+// see landmarks_bound), so an evaluated cell can later be reached more
+// cheaply and has to be evaluated again
+static inline bool reopens_closed(const AStarContext_Typedef* ctx) {
+    return ctx->landmarks && ctx->landmarks->scale > 1;
+}
+
+// Offer a route to an open cell, (re)queueing it if the route is the first
+// or cheapest found so far
+static inline void open_cell(AStarContext_Typedef* ctx, int32_t cell,
+                             int32_t parent, Cost_Typedef g, int x, int y) {
+    if (is_closed(ctx, cell)) {
+        if (!reopens_closed(ctx) || g >= ctx->g_cost[cell]) return;
+        set_seen(ctx, cell);  // Reopen
+        set_state(ctx, cell, CELL_NEIGHBOUR);
+    } else if (!is_seen(ctx, cell)) {
+        set_seen(ctx, cell);
+        set_state(ctx, cell, CELL_NEIGHBOUR);
+    } else if (g >= ctx->g_cost[cell]) {
+        return;
+    }
+    ctx->g_cost[cell] = g;
+    ctx->parent[cell] = parent;
+    if (!queue_push(&ctx->open_nodes_queue, cell, g + h(ctx, x, y))) {
+        ctx->status = SEARCH_FAILED;  // A lost cell could hide the path
+    }
+}
+
+// Jump Point Search (jps.c)
+// Generate the jump points reachable from an evaluated cell, scanning the map
+void jps_expand(AStarContext_Typedef* ctx, int32_t current);
+// Same, reading the jump distances from ctx->jump_table (JPS+)
+void jps_plus_expand(AStarContext_Typedef* ctx, int32_t current);
+
+// Bidirectional A* (bidirectional.c)
+// Set up the backward search and queue both ends, once astar_begin has set up
+// the forward state
+bool bidirectional_begin(AStarContext_Typedef* ctx);
+// Expand one cell from whichever side has the smaller frontier
+SearchStatus_Typedef bidirectional_step(AStarContext_Typedef* ctx);
+
+#endif  // ASTAR_INTERNAL_H
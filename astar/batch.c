@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+
+#include "batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Solve queries of the current batch on one worker's context until none are
+// left
+static void solve_queries(BatchPool_Typedef* pool, AStarContext_Typedef* ctx) {
+    ctx->mode = pool->mode;
+    ctx->jump_table = pool->jump_table;
+    ctx->landmarks = pool->landmarks;
+    ctx->components = pool->components;
+
+    for (;;) {
+        int i = atomic_fetch_add(&pool->next_query, 1);
+        if (i >= pool->query_count) break;
+        const PathQuery_Typedef* query = &pool->queries[i];
+        PathResult_Typedef* result = &pool->results[i];
+
+        result->found = astar_find_path(ctx, query->start, query->target,
+                                        pool->with_paths ? &result->path
+                                                         : NULL);
+        result->cost = COST_MAX;
+        if (result->found) {
+            result->cost = ctx->g_cost[astar_cell_id(ctx, query->target.x,
+                                                     query->target.y)];
+        } else if (pool->with_paths) {
+            result->path.length = 0;
+        }
+        result->expanded_count = ctx->expanded_count;
+    }
+}
+
+// Argument of a helper thread
+typedef struct {
+    BatchPool_Typedef* pool;
+    int worker;
+} Helper_Typedef;
+
+// Helper thread, solves its share of every batch until the pool stops
+static void* helper_main(void* arg) {
+    Helper_Typedef helper = *(Helper_Typedef*)arg;
+    free(arg);
+    BatchPool_Typedef* pool = helper.pool;
+
+    unsigned seen = 0;  // Last batch worked on
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->batch_number == seen) {
+            pthread_cond_wait(&pool->batch_ready, &pool->lock);
+        }
+        if (pool->stopping) break;
+        seen = pool->batch_number;
+        pthread_mutex_unlock(&pool->lock);
+
+        solve_queries(pool, &pool->contexts[helper.worker]);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->helpers_busy == 0) pthread_cond_signal(&pool->batch_done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+bool batch_create(BatchPool_Typedef* pool, const Map_Typedef* map,
+                  int worker_count) {
+    memset(pool, 0, sizeof(*pool));
+    if (worker_count <= 0) worker_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (worker_count <= 0) worker_count = 1;
+    pool->map = map;
+    pool->mode = EXPAND_ASTAR;
+    atomic_init(&pool->next_query, 0);
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) return false;
+    if (pthread_cond_init(&pool->batch_ready, NULL) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        return false;
+    }
+    if (pthread_cond_init(&pool->batch_done, NULL) != 0) {
+        pthread_cond_destroy(&pool->batch_ready);
+        pthread_mutex_destroy(&pool->lock);
+        return false;
+    }
+
+    // Contexts first, so a failure leaves no thread to stop
+    pool->contexts = calloc(worker_count, sizeof(*pool->contexts));
+    pool->threads = calloc(worker_count, sizeof(*pool->threads));
+    bool ok = pool->contexts && pool->threads;
+    for (int i = 0; ok && i < worker_count; i++) {
+        ok = astar_create(&pool->contexts[i], map);
+        if (ok) pool->worker_count = i + 1;
+    }
+    for (int i = 1; ok && i < worker_count; i++) {
+        Helper_Typedef* helper = malloc(sizeof(*helper));
+        ok = helper != NULL;
+        if (ok) {
+            *helper = (Helper_Typedef){pool, i};
+            ok = pthread_create(&pool->threads[i - 1], NULL, helper_main,
+                                helper) == 0;
+            if (!ok) free(helper);
+        }
+        if (ok) pool->thread_count++;
+    }
+    if (!ok) batch_destroy(pool);
+    return ok;
+}
+
+void batch_destroy(BatchPool_Typedef* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->batch_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        astar_destroy(&pool->contexts[i]);
+    }
+    free(pool->contexts);
+    free(pool->threads);
+    pthread_cond_destroy(&pool->batch_done);
+    pthread_cond_destroy(&pool->batch_ready);
+    pthread_mutex_destroy(&pool->lock);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void batch_find_paths(BatchPool_Typedef* pool,
+                      const PathQuery_Typedef* queries,
+                      PathResult_Typedef* results, int count,
+                      bool with_paths) {
+    pthread_mutex_lock(&pool->lock);
+    pool->queries = queries;
+    pool->results = results;
+    pool->query_count = count;
+    pool->with_paths = with_paths;
+    atomic_store(&pool->next_query, 0);
+    pool->helpers_busy = pool->thread_count;
+    pool->batch_number++;
+    pthread_cond_broadcast(&pool->batch_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The calling thread is a worker too
+    solve_queries(pool, &pool->contexts[0]);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->helpers_busy > 0) {
+        pthread_cond_wait(&pool->batch_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
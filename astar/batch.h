@@ -0,0 +1,71 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "astar.h"
+
+// One start / target pair of a batch
+typedef struct {
+    CellPosition_Typedef start;
+    CellPosition_Typedef target;
+} PathQuery_Typedef;
+
+// Answer to one query
+typedef struct {
+    bool found;
+    Cost_Typedef cost;   // Path cost, COST_MAX if not found
+    int expanded_count;  // Cells the search expanded
+    // Only filled in when paths are asked for. Reused between batches, free
+    // with astar_free_path
+    Path_Typedef path;
+} PathResult_Typedef;
+
+// Worker threads solving batches of independent queries over one map. Each
+// worker owns a search context, the map (and any tables below) is shared
+// read-only, so nothing is locked while searching
+typedef struct {
+    const Map_Typedef* map;  // Not owned, must not change during a batch
+    // Search settings, copied to every worker's context before each batch
+    ExpandMode_Typedef mode;
+    const JumpTable_Typedef* jump_table;
+    const LandmarkTable_Typedef* landmarks;
+    const Components_Typedef* components;
+
+    int worker_count;  // Including the thread calling batch_find_paths
+    AStarContext_Typedef* contexts;  // One per worker
+    pthread_t* threads;              // worker_count - 1 helper threads
+    int thread_count;                // Helper threads running
+    pthread_mutex_t lock;
+    pthread_cond_t batch_ready;  // A new batch (or stopping) for the helpers
+    pthread_cond_t batch_done;   // The last helper finished its share
+
+    // Batch being solved, queries are taken in order by whichever worker
+    // is free next
+    const PathQuery_Typedef* queries;
+    PathResult_Typedef* results;
+    int query_count;
+    bool with_paths;
+    atomic_int next_query;
+    unsigned batch_number;  // Bumped for each batch, helpers wait for it
+    int helpers_busy;
+    bool stopping;
+} BatchPool_Typedef;
+
+// Start a pool of worker_count workers over a map (0 uses one per core)
+bool batch_create(BatchPool_Typedef* pool, const Map_Typedef* map,
+                  int worker_count);
+
+// Stop the workers and free their contexts
+void batch_destroy(BatchPool_Typedef* pool);
+
+// Solve count queries into results (one per query), blocking until all are
+// done. Paths are only copied out when with_paths is set
+void batch_find_paths(BatchPool_Typedef* pool,
+                      const PathQuery_Typedef* queries,
+                      PathResult_Typedef* results, int count,
+                      bool with_paths);
+
+#endif  // BATCH_H
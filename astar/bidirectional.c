@@ -0,0 +1,204 @@
+#include <stdlib.h>
+
+#include "astar_internal.h"
+
+// Bidirectional A*. A forward search from the start and a backward search
+// from the target take turns (the one with fewer open cells goes next) and
+// every cell seen by both is a candidate meeting point. Moves are symmetric
+// (a diagonal only needs its destination free) so the backward search expands
+// exactly like the forward one.
+//
+// Each side aims for the average of the two heuristics (Ikeda et al.): a cell
+// is keyed on 2 * g + h(cell, goal) - h(cell, origin) + h(start, target),
+// doubled to stay integral and offset to stay positive. The keys of the two
+// sides then add up to twice the cost of a path through the cell plus a
+// constant, so once the cheapest keys of both sides add up to no less than
+// that for the best meeting point, no cheaper path is left to find. With one
+// sided heuristics the two searches tend to pass each other instead of meeting
+// halfway
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+// One direction of the search
+typedef struct {
+    Cost_Typedef* g_cost;
+    int32_t* parent;
+    uint32_t* stamp;  // Seen / closed generations, as for the forward search
+    Queue_Typedef* queue;
+    CellPosition_Typedef goal;    // Cell the search heads for
+    CellPosition_Typedef origin;  // Cell the search started from
+    // The other direction, for spotting meeting points
+    const Cost_Typedef* other_g_cost;
+    const uint32_t* other_stamp;
+} Side_Typedef;
+
+static Side_Typedef forward_side(AStarContext_Typedef* ctx) {
+    Side_Typedef side = {.g_cost = ctx->g_cost,
+                         .parent = ctx->parent,
+                         .stamp = ctx->stamp,
+                         .queue = &ctx->open_nodes_queue,
+                         .goal = ctx->target,
+                         .origin = ctx->start,
+                         .other_g_cost = ctx->g_cost_back,
+                         .other_stamp = ctx->stamp_back};
+    return side;
+}
+
+static Side_Typedef backward_side(AStarContext_Typedef* ctx) {
+    Side_Typedef side = {.g_cost = ctx->g_cost_back,
+                         .parent = ctx->parent_back,
+                         .stamp = ctx->stamp_back,
+                         .queue = &ctx->back_queue,
+                         .goal = ctx->start,
+                         .origin = ctx->target,
+                         .other_g_cost = ctx->g_cost,
+                         .other_stamp = ctx->stamp};
+    return side;
+}
+
+// Key of a cell on one side of the search (see above)
+static Cost_Typedef key(const AStarContext_Typedef* ctx,
+                        const Side_Typedef* side, Cost_Typedef g, int x,
+                        int y) {
+    return 2 * g + compute_distance(x, y, side->goal.x, side->goal.y) -
+           compute_distance(x, y, side->origin.x, side->origin.y) +
+           compute_distance(ctx->start.x, ctx->start.y, ctx->target.x,
+                            ctx->target.y);
+}
+
+bool bidirectional_begin(AStarContext_Typedef* ctx) {
+    // The backward state costs as much as the forward one, so only searches
+    // that use it pay for it
+    if (!ctx->g_cost_back) {
+        size_t count = (size_t)ctx->map->width * ctx->map->height;
+        ctx->g_cost_back = malloc(count * sizeof(*ctx->g_cost_back));
+        ctx->parent_back = malloc(count * sizeof(*ctx->parent_back));
+        ctx->stamp_back = calloc(count, sizeof(*ctx->stamp_back));
+        if (!ctx->g_cost_back || !ctx->parent_back || !ctx->stamp_back ||
+            !queue_create(&ctx->back_queue, (int)count)) {
+            free(ctx->g_cost_back);
+            free(ctx->parent_back);
+            free(ctx->stamp_back);
+            queue_destroy(&ctx->back_queue);
+            ctx->g_cost_back = NULL;
+            ctx->parent_back = NULL;
+            ctx->stamp_back = NULL;
+            return false;
+        }
+#if !INTEGER_COSTS
+        ctx->back_queue.tie_break = ctx->g_cost_back;
+#endif
+    }
+    queue_clear(&ctx->back_queue);
+    ctx->meeting = -1;
+    ctx->best_cost = COST_MAX;
+
+    int32_t target_id = astar_cell_id(ctx, ctx->target.x, ctx->target.y);
+    ctx->stamp_back[target_id] = ctx->generation;
+    ctx->g_cost_back[target_id] = 0;
+    ctx->parent_back[target_id] = -1;
+    Side_Typedef forward = forward_side(ctx), back = backward_side(ctx);
+    return queue_push(&ctx->open_nodes_queue,
+                      astar_cell_id(ctx, ctx->start.x, ctx->start.y),
+                      key(ctx, &forward, 0, ctx->start.x, ctx->start.y)) &&
+           queue_push(&ctx->back_queue, target_id,
+                      key(ctx, &back, 0, ctx->target.x, ctx->target.y));
+}
+
+// Queue the open neighbours of an evaluated cell on one side, noting any
+// cheaper meeting point with the other side
+static void expand(AStarContext_Typedef* ctx, Side_Typedef* side,
+                   int32_t current) {
+    const Map_Typedef* map = ctx->map;
+    uint32_t generation = ctx->generation;
+    int x = current % map->width, y = current / map->width;
+
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (nx < 0 || nx >= map->width || ny < 0 || ny >= map->height) {
+            continue;
+        }
+        int32_t neighbour = current + neighbour_dy[n] * map->width +
+                            neighbour_dx[n];
+        if (map->barriers[neighbour]) continue;
+        if (side->stamp[neighbour] == generation + 1) continue;  // Closed
+
+        Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+        Cost_Typedef neighbour_g = side->g_cost[current] + step;
+        bool met = side->other_stamp[neighbour] - generation <= 1;
+        if (side->stamp[neighbour] != generation) {
+            side->stamp[neighbour] = generation;
+            if (!met) set_state(ctx, neighbour, CELL_NEIGHBOUR);
+        } else if (neighbour_g >= side->g_cost[neighbour]) {
+            continue;
+        }
+        side->g_cost[neighbour] = neighbour_g;
+        side->parent[neighbour] = current;
+        if (!queue_push(side->queue, neighbour,
+                        key(ctx, side, neighbour_g, nx, ny))) {
+            ctx->status = SEARCH_FAILED;  // A lost cell could hide the path
+            return;
+        }
+
+        // Seen from the other side too, the two halves make a path
+        if (met) {
+            Cost_Typedef cost = neighbour_g + side->other_g_cost[neighbour];
+            if (cost < ctx->best_cost) {
+                ctx->best_cost = cost;
+                ctx->meeting = neighbour;
+            }
+        }
+    }
+}
+
+// Hand the backward half of the best path over to the forward parents, so
+// the path can be read from the target as after a one-way search
+static void splice_path(AStarContext_Typedef* ctx) {
+    int width = ctx->map->width;
+    int32_t cell = ctx->meeting;
+    while (ctx->parent_back[cell] >= 0) {
+        int32_t next = ctx->parent_back[cell];
+        ctx->g_cost[next] = ctx->g_cost[cell] +
+                            compute_distance(cell % width, cell / width,
+                                             next % width, next / width);
+        ctx->parent[next] = cell;
+        if (!is_seen(ctx, next)) set_seen(ctx, next);
+        cell = next;
+    }
+}
+
+SearchStatus_Typedef bidirectional_step(AStarContext_Typedef* ctx) {
+    // Stop once the two sides can't find anything cheaper than the best
+    // meeting point (an exhausted side can't find anything at all)
+    Cost_Typedef forward_key, backward_key;
+    Cost_Typedef offset = compute_distance(ctx->start.x, ctx->start.y,
+                                           ctx->target.x, ctx->target.y);
+    if (!queue_peek(&ctx->open_nodes_queue, &forward_key) ||
+        !queue_peek(&ctx->back_queue, &backward_key) ||
+        (ctx->meeting >= 0 &&
+         forward_key + backward_key >= 2 * (ctx->best_cost + offset))) {
+        if (ctx->meeting < 0) {
+            ctx->status = SEARCH_NO_PATH;
+        } else {
+            splice_path(ctx);
+            ctx->status = SEARCH_FOUND;
+        }
+        return ctx->status;
+    }
+
+    Side_Typedef side = ctx->open_nodes_queue.idx <= ctx->back_queue.idx
+                            ? forward_side(ctx)
+                            : backward_side(ctx);
+    int32_t current;
+    queue_pop(side.queue, &current);
+    ctx->expanded_count++;
+    side.stamp[current] = ctx->generation + 1;
+    if (ctx->state[current] != CELL_START &&
+        ctx->state[current] != CELL_TARGET) {
+        set_state(ctx, current, CELL_VISITED);
+    }
+    expand(ctx, &side, current);
+    return ctx->status;
+}
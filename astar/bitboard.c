@@ -0,0 +1,61 @@
+#include "bitboard.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool bitboard_create(Bitboard_Typedef* board, int line_count,
+                     int line_length) {
+    memset(board, 0, sizeof(*board));
+    int words_per_line =
+        (line_length + BITBOARD_WORD_BITS - 1) / BITBOARD_WORD_BITS;
+    board->words =
+        calloc((size_t)line_count * words_per_line, sizeof(*board->words));
+    if (!board->words) return false;
+    board->words_per_line = words_per_line;
+    board->line_count = line_count;
+    board->line_length = line_length;
+
+    // Padding past the end of each line reads as barriers
+    int used = line_length % BITBOARD_WORD_BITS;
+    if (used) {
+        for (int line = 0; line < line_count; line++) {
+            board->words[(size_t)(line + 1) * words_per_line - 1] =
+                ~UINT64_C(0) << used;
+        }
+    }
+    return true;
+}
+
+void bitboard_destroy(Bitboard_Typedef* board) {
+    free(board->words);
+    memset(board, 0, sizeof(*board));
+}
+
+void bitboard_set(Bitboard_Typedef* board, int line, int position, bool set) {
+    uint64_t* word = &board->words[(size_t)line * board->words_per_line +
+                                   position / BITBOARD_WORD_BITS];
+    uint64_t bit = UINT64_C(1) << (position % BITBOARD_WORD_BITS);
+    *word = set ? (*word | bit) : (*word & ~bit);
+}
+
+// Word of a line, all set when off either end
+static uint64_t line_word(const Bitboard_Typedef* board, const uint64_t* words,
+                          int index) {
+    if (index < 0 || index >= board->words_per_line) return ~UINT64_C(0);
+    return words[index];
+}
+
+uint64_t bitboard_bits(const Bitboard_Typedef* board, int line, int start) {
+    if (line < 0 || line >= board->line_count) return ~UINT64_C(0);
+    const uint64_t* words = &board->words[(size_t)line * board->words_per_line];
+
+    // Floor division, start may be before the beginning of the line
+    int index = start >= 0 ? start / BITBOARD_WORD_BITS
+                           : -((-start + BITBOARD_WORD_BITS - 1) /
+                               BITBOARD_WORD_BITS);
+    int shift = start - index * BITBOARD_WORD_BITS;
+    uint64_t low = line_word(board, words, index);
+    if (!shift) return low;
+    uint64_t high = line_word(board, words, index + 1);
+    return (low >> shift) | (high << (BITBOARD_WORD_BITS - shift));
+}
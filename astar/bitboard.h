@@ -0,0 +1,55 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bits per word of a bitboard
+#define BITBOARD_WORD_BITS 64
+
+// One bit per cell, a set bit is a barrier. Lines are rows of a row-major
+// board or columns of a column-major one, each padded to whole 64-bit words
+// so a run of up to 64 cells can be tested with a single word
+typedef struct {
+    uint64_t* words;
+    int words_per_line;
+    int line_count;
+    int line_length;
+} Bitboard_Typedef;
+
+// Allocate a bitboard with every cell clear
+bool bitboard_create(Bitboard_Typedef* board, int line_count,
+                     int line_length);
+
+// Free a bitboard
+void bitboard_destroy(Bitboard_Typedef* board);
+
+// Set or clear the bit of a cell (must be on the board)
+void bitboard_set(Bitboard_Typedef* board, int line, int position, bool set);
+
+// 64 cells of a line from start onwards, bit i being cell start + i. Cells
+// off the board (either end of the line or a line that doesn't exist) read
+// as set, like barriers
+uint64_t bitboard_bits(const Bitboard_Typedef* board, int line, int start);
+
+// Index of the lowest / highest set bit of a non-zero word
+static inline int bitboard_lowest(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int i = 0;
+    while (!(word & 1)) word >>= 1, i++;
+    return i;
+#endif
+}
+static inline int bitboard_highest(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return BITBOARD_WORD_BITS - 1 - __builtin_clzll(word);
+#else
+    int i = BITBOARD_WORD_BITS - 1;
+    while (!(word >> i)) i--;
+    return i;
+#endif
+}
+
+#endif  // BITBOARD_H
@@ -0,0 +1,291 @@
+#include "components.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Most fills a barrier can start: the free neighbours of a cell fall into
+// at most 4 groups that don't touch each other (the 4 corners)
+#define MAX_FILLS 4
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+static size_t cell_count(const Map_Typedef* map) {
+    return (size_t)map->width * map->height;
+}
+
+// Hand out a label for a new (empty) component, reusing freed ones first
+static int32_t new_label(Components_Typedef* components) {
+    if (components->free_count > 0) {
+        return components->free_labels[--components->free_count];
+    }
+    if (components->label_count == components->label_capacity) {
+        int capacity = components->label_capacity
+                           ? 2 * components->label_capacity
+                           : 64;
+        int32_t* size =
+            realloc(components->size, (size_t)capacity * sizeof(*size));
+        if (!size) return -1;
+        components->size = size;
+        int32_t* free_labels = realloc(components->free_labels,
+                                       (size_t)capacity * sizeof(*free_labels));
+        if (!free_labels) return -1;
+        components->free_labels = free_labels;
+        components->label_capacity = capacity;
+    }
+    components->size[components->label_count] = 0;
+    return components->label_count++;
+}
+
+static void free_label(Components_Typedef* components, int32_t label) {
+    components->free_labels[components->free_count++] = label;
+}
+
+// Give every cell connected to a free cell (and labelled from) a new label,
+// returns the number of cells relabelled
+static int32_t relabel(Components_Typedef* components, int32_t cell,
+                       int32_t from, int32_t to) {
+    const Map_Typedef* map = components->map;
+    int32_t* fill = components->fill_cells;
+    int32_t head = 0, tail = 0;
+    components->label[cell] = to;
+    fill[tail++] = cell;
+
+    while (head < tail) {
+        int32_t current = fill[head++];
+        int x = current % map->width, y = current / map->width;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (blocked(map, nx, ny)) continue;
+            int32_t next = ny * map->width + nx;
+            if (components->label[next] == from) {
+                components->label[next] = to;
+                fill[tail++] = next;
+            }
+        }
+    }
+    return tail;
+}
+
+bool components_create(Components_Typedef* components,
+                       const Map_Typedef* map) {
+    memset(components, 0, sizeof(*components));
+    components->map = map;
+    size_t count = cell_count(map);
+    if (count > INT32_MAX) return false;
+    components->label = malloc(count * sizeof(*components->label));
+    components->fill_cells = malloc(count * sizeof(*components->fill_cells));
+    components->fill_stamp = calloc(count, sizeof(*components->fill_stamp));
+    if (!components->label || !components->fill_cells ||
+        !components->fill_stamp) {
+        components_destroy(components);
+        return false;
+    }
+
+    // Unlabelled free cells start as -2, each one found starts a component
+    for (size_t cell = 0; cell < count; cell++) {
+        components->label[cell] = map->barriers[cell] ? -1 : -2;
+    }
+    for (size_t cell = 0; cell < count; cell++) {
+        if (components->label[cell] != -2) continue;
+        int32_t label = new_label(components);
+        if (label < 0) {
+            components_destroy(components);
+            return false;
+        }
+        components->size[label] =
+            relabel(components, (int32_t)cell, -2, label);
+    }
+    return true;
+}
+
+void components_destroy(Components_Typedef* components) {
+    free(components->label);
+    free(components->size);
+    free(components->free_labels);
+    free(components->fill_cells);
+    free(components->fill_stamp);
+    memset(components, 0, sizeof(*components));
+}
+
+// A cell has been freed: it joins the components around it, which all
+// merge into the largest of them
+static bool join_cell(Components_Typedef* components, int32_t cell) {
+    const Map_Typedef* map = components->map;
+    int x = cell % map->width, y = cell / map->width;
+    int32_t largest = -1;
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (blocked(map, nx, ny)) continue;
+        int32_t label = components->label[ny * map->width + nx];
+        if (largest < 0 ||
+            components->size[label] > components->size[largest]) {
+            largest = label;
+        }
+    }
+    if (largest < 0) {
+        largest = new_label(components);  // On its own
+        if (largest < 0) return false;
+    }
+    components->label[cell] = largest;
+    components->size[largest]++;
+
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (blocked(map, nx, ny)) continue;
+        int32_t neighbour = ny * map->width + nx;
+        int32_t label = components->label[neighbour];
+        if (label == largest) continue;
+        components->size[largest] +=
+            relabel(components, neighbour, label, largest);
+        components->size[label] = 0;
+        free_label(components, label);
+    }
+    return true;
+}
+
+// Follow merged fills to the one that stands for them all
+static int find_fill(const int* merged, int fill) {
+    while (merged[fill] != fill) fill = merged[fill];
+    return fill;
+}
+
+// Split the free neighbours of a cell into groups that touch each other
+// (without going through the cell), writing one cell of each group to seeds.
+// Returns the number of groups
+static int neighbour_groups(const Map_Typedef* map, int32_t cell,
+                            int32_t seeds[MAX_FILLS]) {
+    int x = cell % map->width, y = cell / map->width;
+    int group[NEIGHBOURS_COUNT];
+    int group_count = 0;
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        group[n] = -1;
+        if (blocked(map, x + neighbour_dx[n], y + neighbour_dy[n])) continue;
+        group[n] = group_count++;
+    }
+
+    // Neighbours one step apart are in the same group, merge until stable
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int a = 0; a < NEIGHBOURS_COUNT; a++) {
+            for (int b = 0; b < NEIGHBOURS_COUNT; b++) {
+                if (group[a] < 0 || group[b] <= group[a] ||
+                    abs(neighbour_dx[a] - neighbour_dx[b]) > 1 ||
+                    abs(neighbour_dy[a] - neighbour_dy[b]) > 1) {
+                    continue;
+                }
+                group[b] = group[a];
+                changed = true;
+            }
+        }
+    }
+
+    int seed_count = 0;
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        bool first = group[n] >= 0;
+        for (int m = 0; m < n && first; m++) first = group[m] != group[n];
+        if (first) {
+            seeds[seed_count++] =
+                (y + neighbour_dy[n]) * map->width + x + neighbour_dx[n];
+        }
+    }
+    return seed_count;
+}
+
+// A barrier has cut a component, whose cells around it may no longer reach
+// each other. One breadth-first fill starts from each group of neighbours,
+// all sharing a queue so they advance in step. Fills that meet are merged,
+// a fill that runs out of cells has found a separate component and is
+// relabelled. Once a single fill is left its cells keep the old label, so
+// the largest part is never walked in full
+static bool split_component(Components_Typedef* components, int32_t label,
+                            const int32_t seeds[MAX_FILLS], int fill_count) {
+    const Map_Typedef* map = components->map;
+    int32_t* fill = components->fill_cells;
+    uint32_t* stamp = components->fill_stamp;
+    components->fill_generation += MAX_FILLS;
+    if (components->fill_generation == 0) {
+        memset(stamp, 0, cell_count(map) * sizeof(*stamp));
+        components->fill_generation = MAX_FILLS;
+    }
+    uint32_t generation = components->fill_generation;
+
+    int merged[MAX_FILLS];   // Fill each fill was merged into
+    int32_t queued[MAX_FILLS];  // Cells still queued, for unmerged fills
+    int32_t head = 0, tail = 0;
+    for (int f = 0; f < fill_count; f++) {
+        merged[f] = f;
+        queued[f] = 1;
+        stamp[seeds[f]] = generation + f;
+        fill[tail++] = seeds[f];
+    }
+
+    int active = fill_count;
+    while (active > 1 && head < tail) {
+        int32_t current = fill[head++];
+        int f = find_fill(merged, (int)(stamp[current] - generation));
+        queued[f]--;
+
+        int x = current % map->width, y = current / map->width;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (blocked(map, nx, ny)) continue;
+            int32_t next = ny * map->width + nx;
+            uint32_t reached = stamp[next] - generation;
+            if (reached >= MAX_FILLS) {
+                stamp[next] = generation + f;
+                fill[tail++] = next;
+                queued[f]++;
+                continue;
+            }
+            int other = find_fill(merged, (int)reached);
+            if (other != f) {
+                merged[other] = f;  // Met, so still one component
+                queued[f] += queued[other];
+                active--;
+            }
+        }
+
+        if (queued[f] == 0) {
+            // Nothing left to reach, every cell this fill found is cut off
+            int32_t part = new_label(components);
+            if (part < 0) return false;
+            for (int32_t i = 0; i < tail; i++) {
+                if (find_fill(merged, (int)(stamp[fill[i]] - generation)) ==
+                    f) {
+                    components->label[fill[i]] = part;
+                    components->size[part]++;
+                }
+            }
+            components->size[label] -= components->size[part];
+            active--;
+        }
+    }
+    return true;
+}
+
+bool components_update_cell(Components_Typedef* components, int x, int y) {
+    const Map_Typedef* map = components->map;
+    if (!map_in_bounds(map, x, y)) return false;
+    int32_t cell = y * map->width + x;
+    int32_t label = components->label[cell];
+
+    if (!map->barriers[cell]) {
+        return label >= 0 || join_cell(components, cell);
+    }
+    if (label < 0) return true;  // Already a barrier
+
+    components->label[cell] = -1;
+    if (--components->size[label] == 0) {
+        free_label(components, label);
+        return true;
+    }
+    int32_t seeds[MAX_FILLS];
+    int fill_count = neighbour_groups(map, cell, seeds);
+    return fill_count <= 1 ||
+           split_component(components, label, seeds, fill_count);
+}
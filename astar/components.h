@@ -0,0 +1,51 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "map.h"
+
+// Connected components of the free cells of a map, so that a search between
+// cells that can't reach each other is turned down without exploring
+// anything. Cells are connected as searches move, to any of their 8
+// neighbours. Kept up to date through barrier edits with
+// components_update_cell, and shared (read-only) by every search over the map
+typedef struct {
+    const Map_Typedef* map;  // Map the labels are for (not owned)
+    int32_t* label;          // Component of each cell, -1 for barriers
+    int32_t* size;           // Cells in each component, indexed by label
+    int label_count;         // Labels handed out (some may be free)
+    int label_capacity;
+    int32_t* free_labels;  // Labels of components that have disappeared
+    int free_count;
+    // Scratch for the flood fills of updates: the cells reached (in the
+    // order reached) and which fill reached each cell, as fill_generation
+    // plus the fill's number
+    int32_t* fill_cells;
+    uint32_t* fill_stamp;
+    uint32_t fill_generation;
+} Components_Typedef;
+
+// Label the components of a map
+bool components_create(Components_Typedef* components, const Map_Typedef* map);
+
+// Free the labels
+void components_destroy(Components_Typedef* components);
+
+// Bring the labels up to date after a barrier has been added or removed at
+// (x, y) with map_set_barrier. Only the component(s) around the cell are
+// relabelled, and when a barrier splits a component only the smaller parts
+// are visited (in step with the others, stopping once they meet)
+bool components_update_cell(Components_Typedef* components, int x, int y);
+
+// Check if a path can exist between two cells (both must be on the map)
+static inline bool components_connected(const Components_Typedef* components,
+                                        int x1, int y1, int x2, int y2) {
+    int width = components->map->width;
+    int32_t a = components->label[y1 * width + x1];
+    int32_t b = components->label[y2 * width + x2];
+    return a >= 0 && a == b;
+}
+
+#endif  // COMPONENTS_H
@@ -0,0 +1,22 @@
+#ifndef COST_H
+#define COST_H
+
+#include <float.h>
+#include <stdint.h>
+
+// Set to 1 to store costs as 32-bit integers and keep the open queue in
+// buckets keyed by f-cost (Dial's algorithm) instead of a binary heap
+#ifndef INTEGER_COSTS
+#define INTEGER_COSTS 0
+#endif
+
+// Cost of travelling between cells
+#if INTEGER_COSTS
+typedef int32_t Cost_Typedef;
+#define COST_MAX INT32_MAX
+#else
+typedef double Cost_Typedef;
+#define COST_MAX DBL_MAX
+#endif
+
+#endif  // COST_H
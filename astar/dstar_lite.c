@@ -0,0 +1,293 @@
+#include "dstar_lite.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Each cell has a settled distance to the target (g_cost) and a lookahead
+// (rhs) worked out from its neighbours' settled distances. Cells where the
+// two differ are queued and settled cheapest first, much like A* run from
+// the target towards the start. A barrier change only unsettles the cells
+// around it, and only the unsettled cells that could affect the path from
+// the start are expanded again
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+static size_t cell_count(const DStarLite_Typedef* planner) {
+    return (size_t)planner->map->width * planner->map->height;
+}
+
+static int32_t cell_id(const DStarLite_Typedef* planner,
+                       CellPosition_Typedef position) {
+    return position.y * planner->map->width + position.x;
+}
+
+// Make the state of a cell current, cells not yet explored by this plan
+// can't reach the target
+static void touch(DStarLite_Typedef* planner, int32_t id) {
+    if (planner->stamp[id] == planner->generation) return;
+    planner->stamp[id] = planner->generation;
+    planner->g_cost[id] = COST_MAX;
+    planner->rhs[id] = COST_MAX;
+}
+
+static Cost_Typedef g_of(const DStarLite_Typedef* planner, int32_t id) {
+    return planner->stamp[id] == planner->generation ? planner->g_cost[id]
+                                                     : COST_MAX;
+}
+
+static Cost_Typedef rhs_of(const DStarLite_Typedef* planner, int32_t id) {
+    return planner->stamp[id] == planner->generation ? planner->rhs[id]
+                                                     : COST_MAX;
+}
+
+// Queue key of a cell. Unlike A* the distance is to the start, plus how far
+// the start has moved so keys queued before a move stay comparable
+static Cost_Typedef key(const DStarLite_Typedef* planner, int32_t id) {
+    Cost_Typedef g = g_of(planner, id), rhs = rhs_of(planner, id);
+    Cost_Typedef distance = g < rhs ? g : rhs;
+    if (distance == COST_MAX) return COST_MAX;
+    int width = planner->map->width;
+    return distance +
+           compute_distance(id % width, id / width, planner->start.x,
+                            planner->start.y) +
+           planner->key_offset;
+}
+
+// Queue a cell if it is unsettled, take it off the queue otherwise
+static void requeue(DStarLite_Typedef* planner, int32_t id) {
+    if (planner->g_cost[id] != planner->rhs[id]) {
+        if (!queue_push(&planner->queue, id, key(planner, id))) {
+            planner->out_of_memory = true;
+        }
+    } else {
+        queue_remove(&planner->queue, id);
+    }
+}
+
+// Work out the lookahead of a cell from all its neighbours
+static void update_cell(DStarLite_Typedef* planner, int32_t id) {
+    const Map_Typedef* map = planner->map;
+    int x = id % map->width, y = id / map->width;
+    touch(planner, id);
+
+    Cost_Typedef rhs = COST_MAX;  // Barriers stay unreachable
+    if (x == planner->target.x && y == planner->target.y) {
+        if (!map->barriers[id]) rhs = 0;
+    } else if (!map->barriers[id]) {
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (blocked(map, nx, ny)) continue;
+            Cost_Typedef g = g_of(planner, ny * map->width + nx);
+            if (g == COST_MAX) continue;
+            Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+            if (g + step < rhs) rhs = g + step;
+        }
+    }
+    planner->rhs[id] = rhs;
+    requeue(planner, id);
+}
+
+// Settle a cell whose lookahead is cheaper than its distance, neighbours may
+// now reach the target through it
+static void lower_cell(DStarLite_Typedef* planner, int32_t id) {
+    const Map_Typedef* map = planner->map;
+    int x = id % map->width, y = id / map->width;
+    Cost_Typedef g = planner->g_cost[id] = planner->rhs[id];
+
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (blocked(map, nx, ny)) continue;
+        int32_t neighbour = ny * map->width + nx;
+        Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+        touch(planner, neighbour);
+        if (g + step < planner->rhs[neighbour]) {
+            planner->rhs[neighbour] = g + step;
+            requeue(planner, neighbour);
+        }
+    }
+}
+
+// Unsettle a cell whose distance turned out too low (a barrier appeared on
+// its way to the target), and every neighbour that went through it
+static void raise_cell(DStarLite_Typedef* planner, int32_t id) {
+    const Map_Typedef* map = planner->map;
+    int x = id % map->width, y = id / map->width;
+    Cost_Typedef old_g = planner->g_cost[id];
+    planner->g_cost[id] = COST_MAX;
+
+    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+        int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+        if (blocked(map, nx, ny)) continue;
+        int32_t neighbour = ny * map->width + nx;
+        Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+        if (rhs_of(planner, neighbour) == old_g + step) {
+            update_cell(planner, neighbour);
+        }
+    }
+    update_cell(planner, id);
+}
+
+// Settle unsettled cells until the start is settled and no queued cell could
+// still offer it a cheaper path. Returns true if the target is reachable
+// (false if a cell was lost along the way)
+static bool replan(DStarLite_Typedef* planner) {
+    int32_t start = cell_id(planner, planner->start);
+    planner->expanded_count = 0;
+
+    Cost_Typedef top;
+    while (!planner->out_of_memory && queue_peek(&planner->queue, &top)) {
+        // Cells keyed the same as the start can still lie on its path
+        if (top > key(planner, start) &&
+            g_of(planner, start) == rhs_of(planner, start)) {
+            break;
+        }
+        int32_t current;
+        queue_pop(&planner->queue, &current);
+
+        // Keyed before the start last moved, queue it again at its real key
+        Cost_Typedef current_key = key(planner, current);
+        if (top < current_key) {
+            if (!queue_push(&planner->queue, current, current_key)) {
+                planner->out_of_memory = true;
+            }
+            continue;
+        }
+
+        planner->expanded_count++;
+        if (planner->g_cost[current] > planner->rhs[current]) {
+            lower_cell(planner, current);
+        } else {
+            raise_cell(planner, current);
+        }
+    }
+    return !planner->out_of_memory && g_of(planner, start) != COST_MAX;
+}
+
+bool dstar_lite_create(DStarLite_Typedef* planner, const Map_Typedef* map) {
+    memset(planner, 0, sizeof(*planner));
+    planner->map = map;
+    size_t count = cell_count(planner);
+    if (count > INT32_MAX) return false;
+    planner->g_cost = malloc(count * sizeof(*planner->g_cost));
+    planner->rhs = malloc(count * sizeof(*planner->rhs));
+    planner->stamp = calloc(count, sizeof(*planner->stamp));
+    if (!planner->g_cost || !planner->rhs || !planner->stamp ||
+        !queue_create(&planner->queue, (int)count)) {
+        dstar_lite_destroy(planner);
+        return false;
+    }
+    return true;
+}
+
+void dstar_lite_destroy(DStarLite_Typedef* planner) {
+    free(planner->g_cost);
+    free(planner->rhs);
+    free(planner->stamp);
+    queue_destroy(&planner->queue);
+    memset(planner, 0, sizeof(*planner));
+}
+
+bool dstar_lite_begin(DStarLite_Typedef* planner, CellPosition_Typedef start,
+                      CellPosition_Typedef target) {
+    const Map_Typedef* map = planner->map;
+    if (!map_in_bounds(map, start.x, start.y) ||
+        !map_in_bounds(map, target.x, target.y)) {
+        return false;
+    }
+
+    // Forget the previous plan, as in astar_begin stamps are only cleared
+    // when the generation wraps around
+    if (++planner->generation == 0) {
+        memset(planner->stamp, 0,
+               cell_count(planner) * sizeof(*planner->stamp));
+        planner->generation = 1;
+    }
+    queue_clear(&planner->queue);
+    planner->start = start;
+    planner->target = target;
+    planner->key_offset = 0;
+    planner->out_of_memory = false;
+
+    update_cell(planner, cell_id(planner, target));
+    return replan(planner);
+}
+
+bool dstar_lite_move_start(DStarLite_Typedef* planner,
+                           CellPosition_Typedef start) {
+    if (!planner->generation ||
+        !map_in_bounds(planner->map, start.x, start.y)) {
+        return false;
+    }
+    planner->key_offset += compute_distance(planner->start.x, planner->start.y,
+                                            start.x, start.y);
+    planner->start = start;
+    return replan(planner);
+}
+
+bool dstar_lite_update_cells(DStarLite_Typedef* planner,
+                             const CellPosition_Typedef* cells, int count) {
+    const Map_Typedef* map = planner->map;
+    if (!planner->generation) return false;
+
+    // Moves into and out of an edited cell changed, so the cell and its
+    // neighbours need their lookaheads worked out again
+    for (int i = 0; i < count; i++) {
+        int x = cells[i].x, y = cells[i].y;
+        if (!map_in_bounds(map, x, y)) continue;
+        update_cell(planner, y * map->width + x);
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (map_in_bounds(map, nx, ny)) {
+                update_cell(planner, ny * map->width + nx);
+            }
+        }
+    }
+    return replan(planner);
+}
+
+bool dstar_lite_get_path(const DStarLite_Typedef* planner,
+                         Path_Typedef* out_path) {
+    const Map_Typedef* map = planner->map;
+    int32_t id = cell_id(planner, planner->start);
+    int32_t target = cell_id(planner, planner->target);
+    if (!planner->generation || g_of(planner, id) == COST_MAX) return false;
+
+    // Step to the neighbour that is cheapest to go through, a path can't
+    // be longer than the map has cells
+    out_path->length = 0;
+    for (size_t steps = 0; steps <= cell_count(planner); steps++) {
+        if (out_path->length == out_path->capacity) {
+            int capacity = out_path->capacity ? 2 * out_path->capacity : 64;
+            CellPosition_Typedef* cells =
+                realloc(out_path->cells, capacity * sizeof(*cells));
+            if (!cells) return false;
+            out_path->cells = cells;
+            out_path->capacity = capacity;
+        }
+        int x = id % map->width, y = id / map->width;
+        out_path->cells[out_path->length++] = (CellPosition_Typedef){x, y};
+        if (id == target) return true;
+
+        int32_t next = -1;
+        Cost_Typedef best = COST_MAX;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (blocked(map, nx, ny)) continue;
+            int32_t neighbour = ny * map->width + nx;
+            Cost_Typedef g = g_of(planner, neighbour);
+            if (g == COST_MAX) continue;
+            Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+            if (g + step < best) {
+                best = g + step;
+                next = neighbour;
+            }
+        }
+        if (next < 0) return false;
+        id = next;
+    }
+    return false;
+}
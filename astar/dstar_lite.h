@@ -0,0 +1,63 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astar.h"
+
+// Incremental replanning with D* Lite (Koenig & Likhachev). The search runs
+// backward from the target and keeps its state between plans, so when
+// barriers change or the start moves only the part of the solution that
+// depends on them is repaired. Moves are as in astar_step
+typedef struct {
+    // Barriers being searched around (not owned). Edit them with
+    // map_set_barrier, then report the edited cells to
+    // dstar_lite_update_cells
+    const Map_Typedef* map;
+    // Search state for each cell, indexed by cell id. Only valid for cells
+    // whose stamp is the current generation, other cells are unexplored
+    Cost_Typedef* g_cost;  // Settled distance to the target
+    Cost_Typedef* rhs;     // One step lookahead: cheapest neighbour + step
+    uint32_t* stamp;
+    uint32_t generation;  // Current plan (a new target starts a new one)
+    // Inconsistent cells (g_cost != rhs), keyed on the smaller of the two
+    // plus the distance from the start plus key_offset
+    Queue_Typedef queue;
+    CellPosition_Typedef start;
+    CellPosition_Typedef target;
+    // Sum of the distances the start has moved since the plan began. Keys
+    // queued earlier stay lower bounds instead of being recomputed
+    Cost_Typedef key_offset;
+    int expanded_count;  // Cells taken off the queue by the last (re)plan
+    // A cell couldn't be queued, so the plan can't be trusted: every replan
+    // fails until dstar_lite_begin starts a new one
+    bool out_of_memory;
+} DStarLite_Typedef;
+
+// Allocate the planner state for a map. The map must outlive the planner
+bool dstar_lite_create(DStarLite_Typedef* planner, const Map_Typedef* map);
+
+// Free the planner state
+void dstar_lite_destroy(DStarLite_Typedef* planner);
+
+// Plan from scratch, returns true if the target is reachable
+bool dstar_lite_begin(DStarLite_Typedef* planner, CellPosition_Typedef start,
+                      CellPosition_Typedef target);
+
+// Move the start (usually one step along the path) and replan, returns true
+// if the target is still reachable
+bool dstar_lite_move_start(DStarLite_Typedef* planner,
+                           CellPosition_Typedef start);
+
+// Repair the plan after barriers have been added or removed at cells, returns
+// true if the target is still reachable
+bool dstar_lite_update_cells(DStarLite_Typedef* planner,
+                             const CellPosition_Typedef* cells, int count);
+
+// Copy the current path (start to target) into out_path, following the
+// cheapest neighbour from the start
+bool dstar_lite_get_path(const DStarLite_Typedef* planner,
+                         Path_Typedef* out_path);
+
+#endif  // DSTAR_LITE_H
@@ -0,0 +1,171 @@
+#include "flow_field.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+static size_t cell_count(const Map_Typedef* map) {
+    return (size_t)map->width * map->height;
+}
+
+// Point a cell's next step at its neighbour (dx, dy)
+static void set_direction(FlowField_Typedef* field, int32_t cell, int dx,
+                          int dy) {
+    uint64_t* word = &field->directions[cell / FLOW_CELLS_PER_WORD];
+    int shift = cell % FLOW_CELLS_PER_WORD * 3;
+    *word = (*word & ~((uint64_t)7 << shift)) |
+            (uint64_t)jump_direction(dx, dy) << shift;
+}
+
+// Check if a cell's next step is its neighbour (dx, dy)
+static bool points_to(const FlowField_Typedef* field, int32_t cell, int dx,
+                      int dy) {
+    uint64_t word = field->directions[cell / FLOW_CELLS_PER_WORD];
+    int shift = cell % FLOW_CELLS_PER_WORD * 3;
+    return (int)((word >> shift) & 7) == jump_direction(dx, dy);
+}
+
+// Settle queued cells cheapest first, passing each distance on to any
+// neighbour it shortens (Dijkstra, out from the target). Returns false if it
+// ran out of memory
+static bool settle(FlowField_Typedef* field) {
+    const Map_Typedef* map = field->map;
+    int32_t current;
+    while (queue_pop(&field->queue, &current)) {
+        field->expanded_count++;
+        int x = current % map->width, y = current / map->width;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int dx = neighbour_dx[n], dy = neighbour_dy[n];
+            if (blocked(map, x + dx, y + dy)) continue;
+            int32_t next = current + dy * map->width + dx;
+            Cost_Typedef distance =
+                field->distance[current] + ((dx && dy) ? 14 : 10);
+            if (distance < field->distance[next]) {
+                field->distance[next] = distance;
+                set_direction(field, next, -dx, -dy);
+                if (!queue_push(&field->queue, next, distance)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Give a free cell the best distance its neighbours offer and queue it, the
+// target is always 0. Returns false if it ran out of memory
+static bool reseed(FlowField_Typedef* field, int32_t cell) {
+    const Map_Typedef* map = field->map;
+    if (map->barriers[cell]) return true;
+    int x = cell % map->width, y = cell / map->width;
+    if (x == field->target.x && y == field->target.y) {
+        field->distance[cell] = 0;
+    } else {
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int dx = neighbour_dx[n], dy = neighbour_dy[n];
+            if (blocked(map, x + dx, y + dy)) continue;
+            int32_t next = cell + dy * map->width + dx;
+            if (field->distance[next] == COST_MAX) continue;
+            Cost_Typedef distance =
+                field->distance[next] + ((dx && dy) ? 14 : 10);
+            if (distance < field->distance[cell]) {
+                field->distance[cell] = distance;
+                set_direction(field, cell, dx, dy);
+            }
+        }
+    }
+    if (field->distance[cell] == COST_MAX) return true;
+    return queue_push(&field->queue, cell, field->distance[cell]);
+}
+
+bool flow_field_create(FlowField_Typedef* field, const Map_Typedef* map) {
+    memset(field, 0, sizeof(*field));
+    field->map = map;
+    size_t count = cell_count(map);
+    if (count > INT32_MAX) return false;
+    size_t words = (count + FLOW_CELLS_PER_WORD - 1) / FLOW_CELLS_PER_WORD;
+    field->distance = malloc(count * sizeof(*field->distance));
+    field->directions = calloc(words, sizeof(*field->directions));
+    field->scratch = malloc(count * sizeof(*field->scratch));
+    if (!field->distance || !field->directions || !field->scratch ||
+        !queue_create(&field->queue, (int)count)) {
+        flow_field_destroy(field);
+        return false;
+    }
+    for (size_t cell = 0; cell < count; cell++) {
+        field->distance[cell] = COST_MAX;
+    }
+    return true;
+}
+
+void flow_field_destroy(FlowField_Typedef* field) {
+    free(field->distance);
+    free(field->directions);
+    free(field->scratch);
+    queue_destroy(&field->queue);
+    memset(field, 0, sizeof(*field));
+}
+
+bool flow_field_build(FlowField_Typedef* field, CellPosition_Typedef target) {
+    const Map_Typedef* map = field->map;
+    if (!map_in_bounds(map, target.x, target.y)) return false;
+    for (size_t cell = 0; cell < cell_count(map); cell++) {
+        field->distance[cell] = COST_MAX;
+    }
+    field->target = target;
+    field->expanded_count = 0;
+    queue_clear(&field->queue);
+    return reseed(field, target.y * map->width + target.x) && settle(field);
+}
+
+bool flow_field_update_cells(FlowField_Typedef* field,
+                             const CellPosition_Typedef* cells, int count) {
+    const Map_Typedef* map = field->map;
+    field->expanded_count = 0;
+
+    // A new barrier cuts off every cell whose steps led through it: the
+    // cells pointing at it, the cells pointing at those and so on. Forget
+    // their distances
+    int32_t cut_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (!map_in_bounds(map, cells[i].x, cells[i].y)) continue;
+        int32_t cell = cells[i].y * map->width + cells[i].x;
+        if (!map->barriers[cell] || field->distance[cell] == COST_MAX) {
+            continue;
+        }
+        field->distance[cell] = COST_MAX;
+        field->scratch[cut_count++] = cell;
+    }
+    for (int32_t i = 0; i < cut_count; i++) {
+        int32_t cell = field->scratch[i];
+        int x = cell % map->width, y = cell / map->width;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int dx = neighbour_dx[n], dy = neighbour_dy[n];
+            if (blocked(map, x + dx, y + dy)) continue;
+            int32_t next = cell + dy * map->width + dx;
+            if (field->distance[next] != COST_MAX &&
+                field->distance[next] != 0 &&
+                points_to(field, next, -dx, -dy)) {
+                field->distance[next] = COST_MAX;
+                field->scratch[cut_count++] = next;
+            }
+        }
+    }
+
+    // Cut off and freed cells take what their neighbours offer, then the
+    // search carries on from them (freed cells may shorten the way for
+    // cells that were never cut off too)
+    bool ok = true;
+    for (int32_t i = 0; ok && i < cut_count; i++) {
+        ok = reseed(field, field->scratch[i]);
+    }
+    for (int i = 0; ok && i < count; i++) {
+        if (map_in_bounds(map, cells[i].x, cells[i].y)) {
+            ok = reseed(field, cells[i].y * map->width + cells[i].x);
+        }
+    }
+    return ok && settle(field);
+}
@@ -0,0 +1,62 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astar.h"
+
+// Cells packed into each word of directions (3 bits each)
+#define FLOW_CELLS_PER_WORD 21
+
+// Next step towards one target from every cell of a map, for crowds sharing
+// a destination. Built with a single Dijkstra search out from the target, so
+// an agent's next move is a table lookup instead of a search of its own.
+// Barrier edits are repaired in place with flow_field_update_cells
+typedef struct {
+    const Map_Typedef* map;  // Not owned
+    CellPosition_Typedef target;
+    Cost_Typedef* distance;  // To the target, COST_MAX if it can't be reached
+    // Direction of the next step from each cell (see jump_direction), 3 bits
+    // per cell, FLOW_CELLS_PER_WORD cells to a word
+    uint64_t* directions;
+    Queue_Typedef queue;
+    int32_t* scratch;    // Cells cut off by new barriers, while updating
+    int expanded_count;  // Cells settled by the last build or update
+} FlowField_Typedef;
+
+// Allocate a flow field for a map
+bool flow_field_create(FlowField_Typedef* field, const Map_Typedef* map);
+
+// Free a flow field
+void flow_field_destroy(FlowField_Typedef* field);
+
+// Work out the field for a target from scratch, returns false if the target
+// is off the map or it ran out of memory
+bool flow_field_build(FlowField_Typedef* field, CellPosition_Typedef target);
+
+// Repair the field after barriers have been added or removed at cells (with
+// map_set_barrier). Only cells whose route went through a new barrier, or
+// that can now reach the target more cheaply, are searched again. Returns
+// false if it ran out of memory, the field must then be built again
+bool flow_field_update_cells(FlowField_Typedef* field,
+                             const CellPosition_Typedef* cells, int count);
+
+// Next cell on the way to the target from (x, y). Returns false at the
+// target itself and where the target can't be reached
+static inline bool flow_field_next(const FlowField_Typedef* field, int x,
+                                   int y, CellPosition_Typedef* next) {
+    int32_t cell = y * field->map->width + x;
+    if (field->distance[cell] == 0 || field->distance[cell] == COST_MAX) {
+        return false;
+    }
+    uint64_t word = field->directions[cell / FLOW_CELLS_PER_WORD];
+    int direction = (word >> (cell % FLOW_CELLS_PER_WORD * 3)) & 7;
+    // Undo jump_direction, which skips the middle of the 3x3 square
+    if (direction >= 4) direction++;
+    next->x = x + direction % 3 - 1;
+    next->y = y + direction / 3 - 1;
+    return true;
+}
+
+#endif  // FLOW_FIELD_H
@@ -0,0 +1,588 @@
+#include "hpa.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Free stretches of a border at least this long get a transition at each
+// end, shorter ones a single transition in the middle
+#define ENTRANCE_SPLIT 6
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+// Link between two cells (or nodes) while building the graph
+typedef struct {
+    int32_t from;
+    int32_t to;
+    Cost_Typedef cost;
+} Edge_Typedef;
+
+// Edges collected while building, grown as needed
+typedef struct {
+    Edge_Typedef* edges;
+    int count;
+    int capacity;
+} EdgeList_Typedef;
+
+// Dijkstra confined to one cluster
+typedef struct {
+    Cost_Typedef* distance;  // Indexed by cell within the cluster
+    Queue_Typedef queue;
+} ClusterSearch_Typedef;
+
+// Cluster a cell belongs to
+static int cluster_of(const Hierarchy_Typedef* hpa, int x, int y) {
+    return (y / hpa->cluster_size) * hpa->clusters_x + x / hpa->cluster_size;
+}
+
+static bool add_edge(EdgeList_Typedef* list, int32_t from, int32_t to,
+                     Cost_Typedef cost) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? 2 * list->capacity : 1024;
+        Edge_Typedef* edges =
+            realloc(list->edges, (size_t)capacity * sizeof(*edges));
+        if (!edges) return false;
+        list->edges = edges;
+        list->capacity = capacity;
+    }
+    list->edges[list->count++] = (Edge_Typedef){from, to, cost};
+    return true;
+}
+
+static bool cluster_search_create(ClusterSearch_Typedef* search,
+                                  int cluster_size) {
+    int count = cluster_size * cluster_size;
+    search->distance = malloc((size_t)count * sizeof(*search->distance));
+    if (!search->distance || !queue_create(&search->queue, count)) {
+        free(search->distance);
+        search->distance = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void cluster_search_destroy(ClusterSearch_Typedef* search) {
+    free(search->distance);
+    queue_destroy(&search->queue);
+}
+
+// Distances from a cell to every cell of its cluster, moving only inside the
+// cluster. Cells within the cluster are numbered row by row from its corner.
+// Returns false if it ran out of memory
+static bool cluster_distances(const Hierarchy_Typedef* hpa,
+                              ClusterSearch_Typedef* search, int x, int y) {
+    const Map_Typedef* map = hpa->map;
+    int size = hpa->cluster_size;
+    int x0 = x - x % size, y0 = y - y % size;
+    int x1 = x0 + size < map->width ? x0 + size : map->width;
+    int y1 = y0 + size < map->height ? y0 + size : map->height;
+
+    for (int i = 0; i < size * size; i++) search->distance[i] = COST_MAX;
+    queue_clear(&search->queue);
+    int32_t from = (y - y0) * size + (x - x0);
+    search->distance[from] = 0;
+    if (!queue_push(&search->queue, from, 0)) return false;
+
+    int32_t current;
+    while (queue_pop(&search->queue, &current)) {
+        int cx = x0 + current % size, cy = y0 + current / size;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = cx + neighbour_dx[n], ny = cy + neighbour_dy[n];
+            if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1 ||
+                blocked(map, nx, ny)) {
+                continue;
+            }
+            int32_t next = (ny - y0) * size + (nx - x0);
+            Cost_Typedef step =
+                (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+            Cost_Typedef distance = search->distance[current] + step;
+            if (distance < search->distance[next]) {
+                search->distance[next] = distance;
+                if (!queue_push(&search->queue, next, distance)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Link two free cells either side of a border (both ways), marking them as
+// nodes
+static bool add_transition(EdgeList_Typedef* transitions, int32_t* node_of,
+                           const Map_Typedef* map, int ax, int ay, int bx,
+                           int by) {
+    int32_t a = ay * map->width + ax, b = by * map->width + bx;
+    Cost_Typedef cost = (ax != bx && ay != by) ? 14 : 10;
+    node_of[a] = node_of[b] = 0;
+    return add_edge(transitions, a, b, cost) &&
+           add_edge(transitions, b, a, cost);
+}
+
+// A cluster border, between the lines (columns for a vertical border, rows
+// otherwise) line - 1 (side 0) and line (side 1)
+typedef struct {
+    const Map_Typedef* map;
+    bool vertical;
+    int line;
+} Border_Typedef;
+
+// Position of the cell on one side of a border, at a position along it
+static int border_x(const Border_Typedef* border, int side, int position) {
+    return border->vertical ? border->line - 1 + side : position;
+}
+static int border_y(const Border_Typedef* border, int side, int position) {
+    return border->vertical ? position : border->line - 1 + side;
+}
+
+static bool border_free(const Border_Typedef* border, int side,
+                        int position) {
+    return !blocked(border->map, border_x(border, side, position),
+                    border_y(border, side, position));
+}
+
+// Check if a straight move crosses the border at a position
+static bool border_crossing(const Border_Typedef* border, int position) {
+    return border_free(border, 0, position) && border_free(border, 1, position);
+}
+
+// Link the cell at position_a on side 0 with the cell at position_b on side 1
+static bool border_transition(EdgeList_Typedef* transitions, int32_t* node_of,
+                              const Border_Typedef* border, int position_a,
+                              int position_b) {
+    return add_transition(transitions, node_of, border->map,
+                          border_x(border, 0, position_a),
+                          border_y(border, 0, position_a),
+                          border_x(border, 1, position_b),
+                          border_y(border, 1, position_b));
+}
+
+// Find the transitions across one cluster's stretch of a border, positions
+// first to last
+static bool scan_border(EdgeList_Typedef* transitions, int32_t* node_of,
+                        const Border_Typedef* border, int first, int last) {
+    bool ok = true;
+    int run_start = -1;
+    for (int p = first; p <= last + 1 && ok; p++) {
+        bool crossing = p <= last && border_crossing(border, p);
+        if (crossing && run_start < 0) run_start = p;
+        if (!crossing && run_start >= 0) {
+            // Free stretch from run_start to p - 1
+            if (p - run_start < ENTRANCE_SPLIT) {
+                int middle = (run_start + p - 1) / 2;
+                ok = border_transition(transitions, node_of, border, middle,
+                                       middle);
+            } else {
+                ok = border_transition(transitions, node_of, border,
+                                       run_start, run_start) &&
+                     border_transition(transitions, node_of, border, p - 1,
+                                       p - 1);
+            }
+            run_start = -1;
+        }
+
+        // Diagonal moves across the border away from any straight crossing
+        // (cutting the corners of barriers either side)
+        if (ok && p < last && !border_crossing(border, p) &&
+            !border_crossing(border, p + 1)) {
+            if (border_free(border, 0, p) && border_free(border, 1, p + 1)) {
+                ok = border_transition(transitions, node_of, border, p, p + 1);
+            }
+            if (ok && border_free(border, 0, p + 1) &&
+                border_free(border, 1, p)) {
+                ok = border_transition(transitions, node_of, border, p + 1, p);
+            }
+        }
+    }
+    return ok;
+}
+
+// Find the transitions across the corner where four clusters meet, only
+// needed when the two cells that would join it up straight are barriers
+static bool scan_corner(EdgeList_Typedef* transitions, int32_t* node_of,
+                        const Map_Typedef* map, int x, int y) {
+    bool top_left = !blocked(map, x - 1, y - 1);
+    bool top_right = !blocked(map, x, y - 1);
+    bool bottom_left = !blocked(map, x - 1, y);
+    bool bottom_right = !blocked(map, x, y);
+    if (top_left && bottom_right && !top_right && !bottom_left) {
+        return add_transition(transitions, node_of, map, x - 1, y - 1, x, y);
+    }
+    if (top_right && bottom_left && !top_left && !bottom_right) {
+        return add_transition(transitions, node_of, map, x, y - 1, x - 1, y);
+    }
+    return true;
+}
+
+// Number the marked cells cluster by cluster
+static bool number_nodes(Hierarchy_Typedef* hpa, int32_t* node_of) {
+    const Map_Typedef* map = hpa->map;
+    int size = hpa->cluster_size;
+    int cluster_count = hpa->clusters_x * hpa->clusters_y;
+    hpa->cluster_first =
+        malloc(((size_t)cluster_count + 1) * sizeof(*hpa->cluster_first));
+    if (!hpa->cluster_first) return false;
+
+    int node_count = 0;
+    for (int cluster = 0; cluster < cluster_count; cluster++) {
+        hpa->cluster_first[cluster] = node_count;
+        int x0 = (cluster % hpa->clusters_x) * size;
+        int y0 = (cluster / hpa->clusters_x) * size;
+        for (int y = y0; y < y0 + size && y < map->height; y++) {
+            for (int x = x0; x < x0 + size && x < map->width; x++) {
+                if (node_of[y * map->width + x] >= 0) {
+                    node_of[y * map->width + x] = node_count++;
+                }
+            }
+        }
+    }
+    hpa->cluster_first[cluster_count] = node_count;
+    hpa->node_count = node_count;
+
+    hpa->node_cell = malloc(((size_t)node_count + 1) * sizeof(*hpa->node_cell));
+    if (!hpa->node_cell) return false;
+    for (int32_t cell = 0; cell < map->width * map->height; cell++) {
+        if (node_of[cell] >= 0) hpa->node_cell[node_of[cell]] = cell;
+    }
+    return true;
+}
+
+// Link every pair of nodes of the same cluster that can reach each other
+// inside it. Moves are symmetric, so one search per pair links it both ways
+static bool link_clusters(const Hierarchy_Typedef* hpa,
+                          EdgeList_Typedef* edges,
+                          ClusterSearch_Typedef* search) {
+    int width = hpa->map->width, size = hpa->cluster_size;
+    int cluster_count = hpa->clusters_x * hpa->clusters_y;
+    for (int cluster = 0; cluster < cluster_count; cluster++) {
+        int first = hpa->cluster_first[cluster];
+        int last = hpa->cluster_first[cluster + 1];
+        for (int from = first; from + 1 < last; from++) {
+            int x = hpa->node_cell[from] % width;
+            int y = hpa->node_cell[from] / width;
+            if (!cluster_distances(hpa, search, x, y)) return false;
+            for (int to = from + 1; to < last; to++) {
+                int tx = hpa->node_cell[to] % width;
+                int ty = hpa->node_cell[to] / width;
+                Cost_Typedef distance =
+                    search->distance[(ty % size) * size + tx % size];
+                if (distance != COST_MAX &&
+                    (!add_edge(edges, from, to, distance) ||
+                     !add_edge(edges, to, from, distance))) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Pack the edges into compressed rows
+static bool pack_edges(Hierarchy_Typedef* hpa, const EdgeList_Typedef* edges) {
+    hpa->edge_first =
+        calloc((size_t)hpa->node_count + 1, sizeof(*hpa->edge_first));
+    hpa->edge_to = malloc(((size_t)edges->count + 1) * sizeof(*hpa->edge_to));
+    hpa->edge_cost =
+        malloc(((size_t)edges->count + 1) * sizeof(*hpa->edge_cost));
+    if (!hpa->edge_first || !hpa->edge_to || !hpa->edge_cost) return false;
+
+    for (int i = 0; i < edges->count; i++) {
+        hpa->edge_first[edges->edges[i].from + 1]++;
+    }
+    for (int node = 0; node < hpa->node_count; node++) {
+        hpa->edge_first[node + 1] += hpa->edge_first[node];
+    }
+    int32_t* fill = malloc(((size_t)hpa->node_count + 1) * sizeof(*fill));
+    if (!fill) return false;
+    memcpy(fill, hpa->edge_first,
+           ((size_t)hpa->node_count + 1) * sizeof(*fill));
+    for (int i = 0; i < edges->count; i++) {
+        int32_t slot = fill[edges->edges[i].from]++;
+        hpa->edge_to[slot] = edges->edges[i].to;
+        hpa->edge_cost[slot] = edges->edges[i].cost;
+    }
+    free(fill);
+    return true;
+}
+
+bool hpa_create(Hierarchy_Typedef* hpa, const Map_Typedef* map,
+                int cluster_size) {
+    memset(hpa, 0, sizeof(*hpa));
+    if (cluster_size < 2) return false;
+    hpa->map = map;
+    hpa->cluster_size = cluster_size;
+    hpa->clusters_x = (map->width + cluster_size - 1) / cluster_size;
+    hpa->clusters_y = (map->height + cluster_size - 1) / cluster_size;
+
+    size_t cell_count = (size_t)map->width * map->height;
+    int32_t* node_of = malloc(cell_count * sizeof(*node_of));
+    EdgeList_Typedef edges = {0};
+    ClusterSearch_Typedef search = {0};
+    bool ok = node_of && cluster_search_create(&search, cluster_size);
+    if (ok) memset(node_of, -1, cell_count * sizeof(*node_of));
+
+    // Transitions between neighbouring clusters (as cell ids)
+    for (int cy = 0; ok && cy < hpa->clusters_y; cy++) {
+        for (int cx = 0; ok && cx < hpa->clusters_x; cx++) {
+            int x0 = cx * cluster_size, y0 = cy * cluster_size;
+            int x1 = x0 + cluster_size < map->width ? x0 + cluster_size
+                                                    : map->width;
+            int y1 = y0 + cluster_size < map->height ? y0 + cluster_size
+                                                     : map->height;
+            if (cx > 0) {
+                Border_Typedef left = {map, true, x0};
+                ok = scan_border(&edges, node_of, &left, y0, y1 - 1);
+            }
+            if (ok && cy > 0) {
+                Border_Typedef top = {map, false, y0};
+                ok = scan_border(&edges, node_of, &top, x0, x1 - 1);
+            }
+            if (ok && cx > 0 && cy > 0) {
+                ok = scan_corner(&edges, node_of, map, x0, y0);
+            }
+        }
+    }
+
+    // Number the nodes, then switch the transitions over to node ids and
+    // add the links inside each cluster
+    ok = ok && number_nodes(hpa, node_of);
+    for (int i = 0; ok && i < edges.count; i++) {
+        edges.edges[i].from = node_of[edges.edges[i].from];
+        edges.edges[i].to = node_of[edges.edges[i].to];
+    }
+    ok = ok && link_clusters(hpa, &edges, &search) && pack_edges(hpa, &edges);
+
+    free(node_of);
+    free(edges.edges);
+    cluster_search_destroy(&search);
+    if (!ok) hpa_destroy(hpa);
+    return ok;
+}
+
+void hpa_destroy(Hierarchy_Typedef* hpa) {
+    free(hpa->node_cell);
+    free(hpa->cluster_first);
+    free(hpa->edge_first);
+    free(hpa->edge_to);
+    free(hpa->edge_cost);
+    memset(hpa, 0, sizeof(*hpa));
+}
+
+// Append cells to a path, growing it as needed
+static bool append_cells(Path_Typedef* path, const CellPosition_Typedef* cells,
+                         int count) {
+    if (path->length + count > path->capacity) {
+        int capacity = path->capacity ? path->capacity : 64;
+        while (capacity < path->length + count) capacity *= 2;
+        CellPosition_Typedef* grown =
+            realloc(path->cells, (size_t)capacity * sizeof(*grown));
+        if (!grown) return false;
+        path->cells = grown;
+        path->capacity = capacity;
+    }
+    memcpy(path->cells + path->length, cells, (size_t)count * sizeof(*cells));
+    path->length += count;
+    return true;
+}
+
+// Distances from a cell to the nodes of its cluster, COST_MAX if unreachable
+// inside the cluster
+static Cost_Typedef* node_distances(const Hierarchy_Typedef* hpa,
+                                    ClusterSearch_Typedef* search, int x,
+                                    int y) {
+    int width = hpa->map->width, size = hpa->cluster_size;
+    int cluster = cluster_of(hpa, x, y);
+    int first = hpa->cluster_first[cluster];
+    int count = hpa->cluster_first[cluster + 1] - first;
+    Cost_Typedef* distances = malloc(((size_t)count + 1) * sizeof(*distances));
+    if (!distances) return NULL;
+    if (!cluster_distances(hpa, search, x, y)) {
+        free(distances);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        int32_t cell = hpa->node_cell[first + i];
+        int nx = cell % width, ny = cell / width;
+        distances[i] = search->distance[(ny % size) * size + nx % size];
+    }
+    return distances;
+}
+
+// Offer a route to a node of the abstract search, returns false if it
+// couldn't be queued
+static bool open_node(AStarContext_Typedef* ctx, int32_t node, int32_t parent,
+                      Cost_Typedef g, CellPosition_Typedef position) {
+    if (is_closed(ctx, node)) {
+        if (!reopens_closed(ctx) || g >= ctx->g_cost[node]) return true;
+        set_seen(ctx, node);  // Reopen
+    } else if (!is_seen(ctx, node)) {
+        set_seen(ctx, node);
+    } else if (g >= ctx->g_cost[node]) {
+        return true;
+    }
+    ctx->g_cost[node] = g;
+    ctx->parent[node] = parent;
+    return queue_push(&ctx->open_nodes_queue, node,
+                      g + h(ctx, position.x, position.y));
+}
+
+// A* over the abstract graph, with the start and target joined to the nodes
+// of their clusters as two extra nodes. The per-cell arrays of ctx are
+// indexed by node instead of cell for the duration. Returns the number of
+// waypoints written to waypoints (start to target), 0 if there is no path
+// (or a node couldn't be queued, which sets SEARCH_FAILED)
+static int abstract_search(const Hierarchy_Typedef* hpa,
+                           AStarContext_Typedef* ctx,
+                           const Cost_Typedef* start_distances,
+                           const Cost_Typedef* target_distances,
+                           CellPosition_Typedef* waypoints) {
+    int width = hpa->map->width;
+    int32_t start = hpa->node_count, target = hpa->node_count + 1;
+    int start_cluster = cluster_of(hpa, ctx->start.x, ctx->start.y);
+    int target_cluster = cluster_of(hpa, ctx->target.x, ctx->target.y);
+    int start_first = hpa->cluster_first[start_cluster];
+    int target_first = hpa->cluster_first[target_cluster];
+
+    next_generation(ctx);
+    set_seen(ctx, start);
+    ctx->g_cost[start] = 0;
+    ctx->parent[start] = -1;
+    bool queued = queue_push(&ctx->open_nodes_queue, start,
+                             h(ctx, ctx->start.x, ctx->start.y));
+
+    int32_t current;
+    bool found = false;
+    while (queued && queue_pop(&ctx->open_nodes_queue, &current)) {
+        set_closed(ctx, current);
+        ctx->expanded_count++;
+        if (current == target) {
+            found = true;
+            break;
+        }
+
+        Cost_Typedef g = ctx->g_cost[current];
+        if (current == start) {
+            int count = hpa->cluster_first[start_cluster + 1] - start_first;
+            for (int i = 0; queued && i < count; i++) {
+                if (start_distances[i] == COST_MAX) continue;
+                int32_t cell = hpa->node_cell[start_first + i];
+                queued = open_node(
+                    ctx, start_first + i, current, start_distances[i],
+                    (CellPosition_Typedef){cell % width, cell / width});
+            }
+            continue;
+        }
+
+        int last_edge = hpa->edge_first[current + 1];
+        for (int e = hpa->edge_first[current]; queued && e < last_edge; e++) {
+            int32_t cell = hpa->node_cell[hpa->edge_to[e]];
+            queued = open_node(
+                ctx, hpa->edge_to[e], current, g + hpa->edge_cost[e],
+                (CellPosition_Typedef){cell % width, cell / width});
+        }
+        int32_t cell = hpa->node_cell[current];
+        if (queued &&
+            cluster_of(hpa, cell % width, cell / width) == target_cluster &&
+            target_distances[current - target_first] != COST_MAX) {
+            queued = open_node(ctx, target, current,
+                               g + target_distances[current - target_first],
+                               ctx->target);
+        }
+    }
+    if (!queued) ctx->status = SEARCH_FAILED;
+    if (!found) return 0;
+
+    // Follow the parents back from the target
+    int count = 0;
+    for (int32_t node = target; node != -1; node = ctx->parent[node]) {
+        count++;
+    }
+    int i = count;
+    waypoints[--i] = ctx->target;
+    for (int32_t node = ctx->parent[target]; node != start;
+         node = ctx->parent[node]) {
+        int32_t cell = hpa->node_cell[node];
+        waypoints[--i] = (CellPosition_Typedef){cell % width, cell / width};
+    }
+    waypoints[--i] = ctx->start;
+    return count;
+}
+
+bool hpa_find_path(const Hierarchy_Typedef* hpa, AStarContext_Typedef* ctx,
+                   CellPosition_Typedef start, CellPosition_Typedef target,
+                   Path_Typedef* out_path) {
+    const Map_Typedef* map = hpa->map;
+    // Nothing of an earlier search may pass for this one's result
+    ctx->status = SEARCH_NO_PATH;
+    ctx->expanded_count = 0;
+    if (out_path) out_path->length = 0;
+    if (ctx->map != map || map_is_barrier(map, start.x, start.y) ||
+        map_is_barrier(map, target.x, target.y)) {
+        return false;
+    }
+
+    // Cells in the same or neighbouring clusters (or a map too small for the
+    // graph to fit the arrays of ctx) are searched directly
+    int size = hpa->cluster_size;
+    if ((abs(start.x / size - target.x / size) <= 1 &&
+         abs(start.y / size - target.y / size) <= 1) ||
+        (size_t)hpa->node_count + 2 > (size_t)map->width * map->height) {
+        bool found = astar_find_path(ctx, start, target, out_path);
+        if (!found && out_path) out_path->length = 0;
+        return found;
+    }
+
+    ClusterSearch_Typedef search = {0};
+    Cost_Typedef* start_distances = NULL;
+    Cost_Typedef* target_distances = NULL;
+    CellPosition_Typedef* waypoints =
+        malloc(((size_t)hpa->node_count + 2) * sizeof(*waypoints));
+    bool ok = waypoints && cluster_search_create(&search, hpa->cluster_size);
+    if (ok) {
+        start_distances = node_distances(hpa, &search, start.x, start.y);
+        target_distances = node_distances(hpa, &search, target.x, target.y);
+        ok = start_distances && target_distances;
+    }
+    if (!ok) ctx->status = SEARCH_FAILED;
+
+    int count = 0;
+    if (ok) {
+        ctx->start = start;
+        ctx->target = target;
+        count = abstract_search(hpa, ctx, start_distances, target_distances,
+                                waypoints);
+        ok = count > 0;
+    }
+
+    // Refine the abstract path with searches on the map, dropping the first
+    // cell of every piece after the first (the end of the last one). Every
+    // other waypoint is skipped, leaving each search a cluster border to
+    // cross where it likes rather than at the precomputed transition
+    Path_Typedef piece = {0};
+    int expanded_count = ctx->expanded_count;
+    for (int i = 0; ok && i + 1 < count; i += 2) {
+        int next = i + 2 < count ? i + 2 : count - 1;
+        ok = astar_find_path(ctx, waypoints[i], waypoints[next], &piece);
+        expanded_count += ctx->expanded_count;
+        if (ok && out_path) {
+            int skip = i > 0 ? 1 : 0;
+            ok = append_cells(out_path, piece.cells + skip,
+                              piece.length - skip);
+            if (!ok) ctx->status = SEARCH_FAILED;
+        }
+    }
+    ctx->expanded_count = expanded_count;  // Abstract and refining searches
+    if (!ok) {
+        // The parents may hold abstract nodes or a part of the path
+        if (ctx->status != SEARCH_FAILED) ctx->status = SEARCH_NO_PATH;
+        if (out_path) out_path->length = 0;
+    }
+
+    astar_free_path(&piece);
+    free(waypoints);
+    free(start_distances);
+    free(target_distances);
+    cluster_search_destroy(&search);
+    return ok;
+}
@@ -0,0 +1,50 @@
+#ifndef HPA_H
+#define HPA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astar.h"
+
+// Default width and height of a cluster (cells)
+#define HPA_CLUSTER_SIZE 32
+
+// Hierarchical pathfinding (HPA*, Botea et al.) over a static map. The map is
+// cut into square clusters, cells either side of each free stretch of a
+// cluster border become nodes of a small abstract graph, and nodes of the
+// same cluster are linked by their shortest distance inside it. Built once
+// and shared (read-only) by every search over the map
+typedef struct {
+    const Map_Typedef* map;  // Map the hierarchy was built from (not owned)
+    int cluster_size;
+    int clusters_x;
+    int clusters_y;
+    int node_count;
+    int32_t* node_cell;      // Cell id of each node, grouped by cluster
+    int32_t* cluster_first;  // First node of each cluster (+1 entry at the end)
+    // Edges of each node (compressed rows, node_count + 1 entries)
+    int32_t* edge_first;
+    int32_t* edge_to;
+    Cost_Typedef* edge_cost;
+} Hierarchy_Typedef;
+
+// Build the abstract graph of a map. The map must not change while the
+// hierarchy is in use (rebuild it after editing barriers)
+bool hpa_create(Hierarchy_Typedef* hpa, const Map_Typedef* map,
+                int cluster_size);
+
+// Free a hierarchy
+void hpa_destroy(Hierarchy_Typedef* hpa);
+
+// Find a near-optimal path by searching the abstract graph, then refine each
+// abstract step with a search on ctx (in ctx->mode) and join the pieces into
+// out_path. ctx must be over the same map. Read the path from out_path:
+// afterwards ctx only holds the last refined piece (its start and target are
+// that piece's ends) and expanded_count totals every search made. On failure
+// out_path is empty and ctx->status is SEARCH_NO_PATH (SEARCH_FAILED if it
+// ran out of memory)
+bool hpa_find_path(const Hierarchy_Typedef* hpa, AStarContext_Typedef* ctx,
+                   CellPosition_Typedef start, CellPosition_Typedef target,
+                   Path_Typedef* out_path);
+
+#endif  // HPA_H
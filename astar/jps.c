@@ -0,0 +1,232 @@
+#include <stdlib.h>
+
+#include "astar_internal.h"
+
+// Jump Point Search (Harabor & Grastien). On a uniform-cost grid most
+// neighbours can be reached just as cheaply without passing through the
+// current cell, so only the cells where a path has to turn (jump points) are
+// queued. Diagonal moves may cut corners, as in astar_step. JPS+ reads the
+// length of each run from a precomputed JumpTable_Typedef instead of scanning
+
+static int sign(int value) { return (value > 0) - (value < 0); }
+
+// Walk from (x, y) along a row (dx) or column (dy) until reaching a jump
+// point: the target or a cell with a forced neighbour. Runs are scanned 64
+// cells at a time in the map's bitboards, a forced neighbour being a barrier
+// in a side line followed by a free cell. Returns the cell id or -1 if a
+// barrier or the edge of the map comes first
+static int32_t jump_straight(const AStarContext_Typedef* ctx, int x, int y,
+                             int dx, int dy) {
+    const Map_Typedef* map = ctx->map;
+    const Bitboard_Typedef* board = dx ? &map->rows : &map->columns;
+    int line = dx ? y : x, position = dx ? x : y, dir = dx ? dx : dy;
+    int target_line = dx ? ctx->target.y : ctx->target.x;
+    int target = dx ? ctx->target.x : ctx->target.y;
+    if (target_line != line || sign(target - position) != dir) target = -1;
+
+    for (;;) {
+        // Next 64 cells, going right or down bit i is position + 1 + i,
+        // going left or up bit 63 - i is position - 1 - i
+        int start = dir > 0 ? position + 1 : position - BITBOARD_WORD_BITS;
+        uint64_t cells = bitboard_bits(board, line, start);
+        uint64_t side = bitboard_bits(board, line - 1, start);
+        uint64_t side_next = bitboard_bits(board, line - 1, start + dir);
+        uint64_t forced = side & ~side_next;
+        side = bitboard_bits(board, line + 1, start);
+        side_next = bitboard_bits(board, line + 1, start + dir);
+        forced |= side & ~side_next;
+
+        // Cells up to the first stop (the map edge reads as a barrier) or
+        // through all 64 if there is none
+        uint64_t stops = cells | forced;
+        int end = position + dir * BITBOARD_WORD_BITS;
+        if (stops) {
+            end = dir > 0 ? start + bitboard_lowest(stops)
+                          : start + bitboard_highest(stops);
+        }
+        if (target >= 0 && (target - end) * dir <= 0) {
+            position = target;
+            break;
+        }
+        if (stops) {
+            if ((cells >> (end - start)) & 1) return -1;  // Barrier
+            position = end;
+            break;
+        }
+        position += dir * BITBOARD_WORD_BITS;
+    }
+    return dx ? line * map->width + position : position * map->width + line;
+}
+
+// Walk from (x, y) in direction (dx, dy) until reaching a jump point: the
+// target or a cell with a forced neighbour. Diagonal runs also stop where a
+// straight run leaving them finds a jump point. Returns the cell id or -1 if
+// a barrier or the edge of the map comes first
+static int32_t jump(const AStarContext_Typedef* ctx, int x, int y, int dx,
+                    int dy) {
+    if (!dx || !dy) return jump_straight(ctx, x, y, dx, dy);
+
+    const Map_Typedef* map = ctx->map;
+    for (;;) {
+        x += dx;
+        y += dy;
+        if (blocked(map, x, y)) return -1;
+        int32_t id = astar_cell_id(ctx, x, y);
+        if (x == ctx->target.x && y == ctx->target.y) return id;
+
+        if (has_forced_neighbour(map, x, y, dx, dy) ||
+            jump_straight(ctx, x, y, dx, 0) >= 0 ||
+            jump_straight(ctx, x, y, 0, dy) >= 0) {
+            return id;
+        }
+    }
+}
+
+// Jump points only store the jump point they came from, fill in the cells
+// between them so the parents of a found path are neighbours again
+static void fill_path(AStarContext_Typedef* ctx) {
+    int width = ctx->map->width;
+    int32_t id = astar_cell_id(ctx, ctx->target.x, ctx->target.y);
+    while (ctx->parent[id] >= 0) {
+        int32_t from = ctx->parent[id];
+        int x = id % width, y = id / width;
+        int fx = from % width, fy = from / width;
+        int dx = sign(fx - x), dy = sign(fy - y);
+
+        int32_t cell = id;
+        while (cell + dy * width + dx != from) {
+            int32_t next = cell + dy * width + dx;
+            x += dx;
+            y += dy;
+            if (!is_seen(ctx, next)) {
+                set_seen(ctx, next);
+                set_state(ctx, next, CELL_EMPTY);
+            }
+            ctx->g_cost[next] =
+                ctx->g_cost[from] + compute_distance(x, y, fx, fy);
+            ctx->parent[cell] = next;
+            cell = next;
+        }
+        ctx->parent[cell] = from;
+        id = from;
+    }
+}
+
+// Directions worth jumping in from an evaluated cell: the way it was
+// reached (natural neighbours) and towards any forced neighbours. The start
+// has no direction so tries all 8. Returns the number of directions
+static int pruned_directions(const AStarContext_Typedef* ctx, int32_t current,
+                             CellPosition_Typedef dirs[NEIGHBOURS_COUNT]) {
+    const Map_Typedef* map = ctx->map;
+    int x = current % map->width, y = current / map->width;
+    int dir_count = 0;
+    if (ctx->parent[current] < 0) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (!dx && !dy) continue;
+                dirs[dir_count++] = (CellPosition_Typedef){dx, dy};
+            }
+        }
+        return dir_count;
+    }
+
+    int32_t parent = ctx->parent[current];
+    int dx = sign(x - parent % map->width);
+    int dy = sign(y - parent / map->width);
+    if (dx && dy) {
+        dirs[dir_count++] = (CellPosition_Typedef){dx, dy};
+        dirs[dir_count++] = (CellPosition_Typedef){dx, 0};
+        dirs[dir_count++] = (CellPosition_Typedef){0, dy};
+        if (blocked(map, x - dx, y)) {
+            dirs[dir_count++] = (CellPosition_Typedef){-dx, dy};
+        }
+        if (blocked(map, x, y - dy)) {
+            dirs[dir_count++] = (CellPosition_Typedef){dx, -dy};
+        }
+    } else if (dx) {
+        dirs[dir_count++] = (CellPosition_Typedef){dx, 0};
+        if (blocked(map, x, y + 1)) {
+            dirs[dir_count++] = (CellPosition_Typedef){dx, 1};
+        }
+        if (blocked(map, x, y - 1)) {
+            dirs[dir_count++] = (CellPosition_Typedef){dx, -1};
+        }
+    } else {
+        dirs[dir_count++] = (CellPosition_Typedef){0, dy};
+        if (blocked(map, x + 1, y)) {
+            dirs[dir_count++] = (CellPosition_Typedef){1, dy};
+        }
+        if (blocked(map, x - 1, y)) {
+            dirs[dir_count++] = (CellPosition_Typedef){-1, dy};
+        }
+    }
+    return dir_count;
+}
+
+// Queue a jump point reached from an evaluated cell, returns true if it is
+// the target (which ends the search)
+static bool add_jump_point(AStarContext_Typedef* ctx, int32_t current,
+                           int32_t point) {
+    int width = ctx->map->width;
+    int x = current % width, y = current / width;
+    int px = point % width, py = point / width;
+    Cost_Typedef point_g =
+        ctx->g_cost[current] + compute_distance(x, y, px, py);
+
+    // The jump is a straight or diagonal run, so its cost is exactly the
+    // heuristic and, as with neighbours in astar_step, the first route to
+    // reach the target is optimal
+    if (px == ctx->target.x && py == ctx->target.y) {
+        ctx->g_cost[point] = point_g;
+        ctx->parent[point] = current;
+        ctx->status = SEARCH_FOUND;
+        fill_path(ctx);
+        return true;
+    }
+    open_cell(ctx, point, current, point_g, px, py);
+    return false;
+}
+
+void jps_expand(AStarContext_Typedef* ctx, int32_t current) {
+    int x = current % ctx->map->width, y = current / ctx->map->width;
+    CellPosition_Typedef dirs[NEIGHBOURS_COUNT];  // (dx, dy) offsets
+    int dir_count = pruned_directions(ctx, current, dirs);
+
+    for (int d = 0; d < dir_count; d++) {
+        int32_t point = jump(ctx, x, y, dirs[d].x, dirs[d].y);
+        if (point >= 0 && add_jump_point(ctx, current, point)) return;
+    }
+}
+
+void jps_plus_expand(AStarContext_Typedef* ctx, int32_t current) {
+    const JumpTable_Typedef* table = ctx->jump_table;
+    int x = current % ctx->map->width, y = current / ctx->map->width;
+    int tx = ctx->target.x - x, ty = ctx->target.y - y;
+    CellPosition_Typedef dirs[NEIGHBOURS_COUNT];  // (dx, dy) offsets
+    int dir_count = pruned_directions(ctx, current, dirs);
+
+    for (int d = 0; d < dir_count; d++) {
+        int dx = dirs[d].x, dy = dirs[d].y;
+        int distance = jump_table_distance(table, current, dx, dy);
+        int reach = abs(distance);  // Free cells before the next stop
+
+        // The table knows nothing about the target, stop where the run
+        // meets it or, for diagonal runs, lines up with its row or column
+        int steps = 0;
+        if (dx && dy) {
+            if (sign(tx) == dx && sign(ty) == dy) {
+                steps = abs(tx) < abs(ty) ? abs(tx) : abs(ty);
+            }
+        } else if (dx ? (ty == 0 && sign(tx) == dx)
+                      : (tx == 0 && sign(ty) == dy)) {
+            steps = dx ? abs(tx) : abs(ty);
+        }
+        if (steps == 0 || steps > reach) {
+            if (distance <= 0) continue;  // Runs into a barrier
+            steps = distance;
+        }
+
+        int32_t point = astar_cell_id(ctx, x + steps * dx, y + steps * dy);
+        if (add_jump_point(ctx, current, point)) return;
+    }
+}
@@ -0,0 +1,60 @@
+#include "jump_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Fill in the distances of one direction for every cell. Cells are visited
+// against the direction so the next cell along each run is always done first
+static void fill_direction(JumpTable_Typedef* table, int dx, int dy) {
+    const Map_Typedef* map = table->map;
+    int direction = jump_direction(dx, dy);
+    int x_first = dx > 0 ? map->width - 1 : 0, x_step = dx > 0 ? -1 : 1;
+    int y_first = dy > 0 ? map->height - 1 : 0, y_step = dy > 0 ? -1 : 1;
+
+    for (int y = y_first; y >= 0 && y < map->height; y += y_step) {
+        for (int x = x_first; x >= 0 && x < map->width; x += x_step) {
+            int nx = x + dx, ny = y + dy;
+            int32_t next = ny * map->width + nx;
+            int distance;
+            if (blocked(map, nx, ny)) {
+                distance = 0;
+            } else if (has_forced_neighbour(map, nx, ny, dx, dy)) {
+                distance = 1;
+            } else if (dx && dy &&
+                       (jump_table_distance(table, next, dx, 0) > 0 ||
+                        jump_table_distance(table, next, 0, dy) > 0)) {
+                distance = 1;  // A straight run from the next cell stops
+            } else {
+                // Carry on along the run of the next cell
+                int rest = jump_table_distance(table, next, dx, dy);
+                distance = rest > 0 ? rest + 1 : rest - 1;
+            }
+            table->distances[((size_t)y * map->width + x) * JUMP_DIRECTIONS +
+                             direction] = (int16_t)distance;
+        }
+    }
+}
+
+bool jump_table_create(JumpTable_Typedef* table, const Map_Typedef* map) {
+    memset(table, 0, sizeof(*table));
+    if (map->width > INT16_MAX || map->height > INT16_MAX) return false;
+    size_t count = (size_t)map->width * map->height * JUMP_DIRECTIONS;
+    table->distances = malloc(count * sizeof(*table->distances));
+    if (!table->distances) return false;
+    table->map = map;
+
+    // Straight runs first, diagonal runs stop where they find one
+    static const int order_dx[JUMP_DIRECTIONS] = {1, -1, 0, 0, 1, -1, 1, -1};
+    static const int order_dy[JUMP_DIRECTIONS] = {0, 0, 1, -1, 1, 1, -1, -1};
+    for (int d = 0; d < JUMP_DIRECTIONS; d++) {
+        fill_direction(table, order_dx[d], order_dy[d]);
+    }
+    return true;
+}
+
+void jump_table_destroy(JumpTable_Typedef* table) {
+    free(table->distances);
+    memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,42 @@
+#ifndef JUMP_TABLE_H
+#define JUMP_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "map.h"
+
+// Directions stored for each cell
+#define JUMP_DIRECTIONS 8
+
+// Jump distances of a static map for JPS+, built once and shared (read-only)
+// by every search over the map. For each cell and direction a positive
+// distance d means the run stops at the jump point d cells away, zero or a
+// negative -d means it runs into a barrier after d free cells
+typedef struct {
+    const Map_Typedef* map;  // Map the table was built from (not owned)
+    int16_t* distances;      // JUMP_DIRECTIONS per cell, indexed by cell id
+} JumpTable_Typedef;
+
+// Precompute the jump distances of a map. The map must not change while the
+// table is in use (rebuild it after editing barriers)
+bool jump_table_create(JumpTable_Typedef* table, const Map_Typedef* map);
+
+// Free a jump table
+void jump_table_destroy(JumpTable_Typedef* table);
+
+// Slot of direction (dx, dy), each -1, 0 or 1, within a cell's distances
+static inline int jump_direction(int dx, int dy) {
+    int direction = (dy + 1) * 3 + (dx + 1);  // 0..8, 4 being no direction
+    return direction > 4 ? direction - 1 : direction;
+}
+
+// Jump distance from a cell in direction (dx, dy)
+static inline int jump_table_distance(const JumpTable_Typedef* table,
+                                      int32_t id, int dx, int dy) {
+    return table->distances[(size_t)id * JUMP_DIRECTIONS +
+                            jump_direction(dx, dy)];
+}
+
+#endif  // JUMP_TABLE_H
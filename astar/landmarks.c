@@ -0,0 +1,223 @@
+#include "landmarks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar_internal.h"
+
+// Start of a landmark file, followed by the landmark cell ids and the
+// distances as laid out in memory (native byte order)
+typedef struct {
+    char magic[4];  // "ALT1"
+    int32_t width;
+    int32_t height;
+    int32_t count;
+    int32_t scale;
+    uint32_t map_hash;  // Of the barriers, see map_hash()
+} LandmarkFileHeader_Typedef;
+
+// Offsets to the 8 neighbours around a cell
+static const int neighbour_dx[NEIGHBOURS_COUNT] = {-1, 1, 1, -1, 1, -1, 0, 0};
+static const int neighbour_dy[NEIGHBOURS_COUNT] = {-1, 1, -1, 1, 0, 0, -1, 1};
+
+// Largest distance that can be stored (LANDMARK_UNREACHABLE is taken)
+#define STORED_MAX (LANDMARK_UNREACHABLE - 1)
+
+static size_t cell_count(const Map_Typedef* map) {
+    return (size_t)map->width * map->height;
+}
+
+// FNV-1a over the barrier layout, to tell whether a saved table still
+// matches the map
+static uint32_t map_hash(const Map_Typedef* map) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < cell_count(map); i++) {
+        hash = (hash ^ (map->barriers[i] != 0)) * 16777619u;
+    }
+    return hash;
+}
+
+// Dijkstra from one cell to every cell of the map (COST_MAX where it can't
+// reach), returns the furthest reachable cell or -1 if it ran out of memory
+static int32_t distances_from(const Map_Typedef* map, Queue_Typedef* queue,
+                              Cost_Typedef* distance, int32_t source) {
+    for (size_t i = 0; i < cell_count(map); i++) distance[i] = COST_MAX;
+    queue_clear(queue);
+    distance[source] = 0;
+    if (!queue_push(queue, source, 0)) return -1;
+
+    int32_t current = source, furthest = source;
+    while (queue_pop(queue, &current)) {
+        furthest = current;  // Cells come off in order of distance
+        int x = current % map->width, y = current / map->width;
+        for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
+            int nx = x + neighbour_dx[n], ny = y + neighbour_dy[n];
+            if (blocked(map, nx, ny)) continue;
+            int32_t next = ny * map->width + nx;
+            Cost_Typedef step = (neighbour_dx[n] && neighbour_dy[n]) ? 14 : 10;
+            if (distance[current] + step < distance[next]) {
+                distance[next] = distance[current] + step;
+                if (!queue_push(queue, next, distance[next])) return -1;
+            }
+        }
+    }
+    return furthest;
+}
+
+// Store the distances of landmark i, first coarsening the scale (by a whole
+// factor, so rows already stored can simply be divided) if they don't fit
+static void store_distances(LandmarkTable_Typedef* table, int i,
+                            const Cost_Typedef* distance, int32_t furthest) {
+    size_t count = cell_count(table->map);
+    int64_t longest = (int64_t)distance[furthest];
+    int factor = 1;
+    while (longest / ((int64_t)table->scale * factor) > STORED_MAX) factor++;
+    if (factor > 1) {
+        for (size_t cell = 0; cell < count; cell++) {
+            for (int j = 0; j < i; j++) {
+                uint16_t* stored = &table->distances[cell * table->count + j];
+                if (*stored != LANDMARK_UNREACHABLE) *stored /= factor;
+            }
+        }
+        table->scale *= factor;
+    }
+
+    for (size_t cell = 0; cell < count; cell++) {
+        table->distances[cell * table->count + i] =
+            distance[cell] == COST_MAX
+                ? LANDMARK_UNREACHABLE
+                : (uint16_t)((int64_t)distance[cell] / table->scale);
+    }
+}
+
+// Allocate an empty table for a map
+static bool allocate_table(LandmarkTable_Typedef* table,
+                           const Map_Typedef* map, int count) {
+    memset(table, 0, sizeof(*table));
+    if (count <= 0 || count > LANDMARK_MAX) return false;
+    table->map = map;
+    table->count = count;
+    table->scale = 1;
+    table->cells = malloc((size_t)count * sizeof(*table->cells));
+    table->distances =
+        malloc(cell_count(map) * count * sizeof(*table->distances));
+    if (!table->cells || !table->distances) {
+        landmarks_destroy(table);
+        return false;
+    }
+    return true;
+}
+
+bool landmarks_create(LandmarkTable_Typedef* table, const Map_Typedef* map,
+                      int count) {
+    size_t cells = cell_count(map);
+    if (cells > INT32_MAX || !allocate_table(table, map, count)) return false;
+
+    int32_t first_free = 0;
+    while ((size_t)first_free < cells && map->barriers[first_free]) {
+        first_free++;
+    }
+    Queue_Typedef queue;
+    Cost_Typedef* distance = malloc(cells * sizeof(*distance));
+    // Distance from each cell to its nearest landmark so far
+    Cost_Typedef* nearest = malloc(cells * sizeof(*nearest));
+    bool ok = (size_t)first_free < cells && distance && nearest &&
+              queue_create(&queue, (int)cells);
+    if (!ok) {
+        free(distance);
+        free(nearest);
+        landmarks_destroy(table);
+        return false;
+    }
+
+    // Landmarks at the far edges of the map give the tightest bounds: the
+    // first is the cell furthest from an arbitrary free cell, each next one
+    // the cell furthest from all landmarks so far
+    int32_t landmark = distances_from(map, &queue, distance, first_free);
+    for (size_t cell = 0; cell < cells; cell++) nearest[cell] = COST_MAX;
+    for (int i = 0; landmark >= 0 && i < count; i++) {
+        table->cells[i] = landmark;
+        int32_t furthest = distances_from(map, &queue, distance, landmark);
+        if (furthest < 0) {
+            landmark = -1;
+            break;
+        }
+        store_distances(table, i, distance, furthest);
+
+        Cost_Typedef best = -1;
+        for (size_t cell = 0; cell < cells; cell++) {
+            if (distance[cell] < nearest[cell]) nearest[cell] = distance[cell];
+            if (nearest[cell] != COST_MAX && nearest[cell] > best) {
+                best = nearest[cell];
+                landmark = (int32_t)cell;
+            }
+        }
+    }
+
+    free(distance);
+    free(nearest);
+    queue_destroy(&queue);
+    if (landmark < 0) {
+        landmarks_destroy(table);
+        return false;
+    }
+    return true;
+}
+
+void landmarks_destroy(LandmarkTable_Typedef* table) {
+    free(table->cells);
+    free(table->distances);
+    memset(table, 0, sizeof(*table));
+}
+
+bool landmarks_save(const LandmarkTable_Typedef* table, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    const Map_Typedef* map = table->map;
+    LandmarkFileHeader_Typedef header = {.magic = {'A', 'L', 'T', '1'},
+                                         .width = map->width,
+                                         .height = map->height,
+                                         .count = table->count,
+                                         .scale = table->scale,
+                                         .map_hash = map_hash(map)};
+    size_t distance_count = cell_count(map) * table->count;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(table->cells, sizeof(*table->cells), table->count,
+                     file) == (size_t)table->count &&
+              fwrite(table->distances, sizeof(*table->distances),
+                     distance_count, file) == distance_count;
+    return fclose(file) == 0 && ok;
+}
+
+bool landmarks_load(LandmarkTable_Typedef* table, const Map_Typedef* map,
+                    const char* path) {
+    memset(table, 0, sizeof(*table));
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    LandmarkFileHeader_Typedef header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, "ALT1", 4) == 0 &&
+              header.width == map->width && header.height == map->height &&
+              header.scale > 0 && header.map_hash == map_hash(map) &&
+              allocate_table(table, map, header.count);
+    if (ok) {
+        size_t distance_count = cell_count(map) * table->count;
+        table->scale = header.scale;
+        ok = fread(table->cells, sizeof(*table->cells), table->count,
+                   file) == (size_t)table->count &&
+             fread(table->distances, sizeof(*table->distances),
+                   distance_count, file) == distance_count;
+    }
+    // Landmarks must be free cells of the map
+    for (int i = 0; ok && i < table->count; i++) {
+        int32_t cell = table->cells[i];
+        ok = cell >= 0 && (size_t)cell < cell_count(map) &&
+             !map->barriers[cell];
+    }
+    fclose(file);
+    if (!ok) landmarks_destroy(table);
+    return ok;
+}
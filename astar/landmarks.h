@@ -0,0 +1,73 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cost.h"
+#include "map.h"
+
+// Default number of landmarks
+#define LANDMARK_COUNT 8
+// Most landmarks a table may have (more cost memory for little gain)
+#define LANDMARK_MAX 32
+
+// Stored distance of a cell a landmark can't reach
+#define LANDMARK_UNREACHABLE UINT16_MAX
+
+// Exact distances from a few landmark cells to every cell of a static map,
+// for the ALT heuristic (A*, Landmarks, Triangle inequality; Goldberg &
+// Harrell). Distances are stored 16 bits per cell and landmark, divided by
+// scale on maps too large for them to fit (scale is 1 otherwise, keeping the
+// heuristic exact). Built once, or loaded from disk, and shared (read-only)
+// by every search over the map
+typedef struct {
+    const Map_Typedef* map;  // Map the table was built for (not owned)
+    int count;               // Number of landmarks
+    int scale;               // Cost units per stored unit
+    int32_t* cells;          // Cell id of each landmark
+    uint16_t* distances;     // count per cell, indexed by cell id
+} LandmarkTable_Typedef;
+
+// Pick count landmarks spread across the map (each as far as possible from
+// the ones before, at most LANDMARK_MAX) and compute their distances with a
+// Dijkstra search each. The map must not change while the table is in use
+// (rebuild it after editing barriers)
+bool landmarks_create(LandmarkTable_Typedef* table, const Map_Typedef* map,
+                      int count);
+
+// Free a landmark table
+void landmarks_destroy(LandmarkTable_Typedef* table);
+
+// Write a table to a file
+bool landmarks_save(const LandmarkTable_Typedef* table, const char* path);
+
+// Read a table written by landmarks_save, fails if it was built for a map
+// with other barriers or is malformed
+bool landmarks_load(LandmarkTable_Typedef* table, const Map_Typedef* map,
+                    const char* path);
+
+// Lower bound on the distance between two cells: by the triangle inequality
+// it is at least the difference of their distances to any landmark. With
+// scale 1 the bound is consistent. Coarser distances keep it admissible but
+// not consistent (rounding can make it drop by more than a step costs), so
+// searches then reopen evaluated cells to keep their paths optimal
+static inline Cost_Typedef landmarks_bound(const LandmarkTable_Typedef* table,
+                                           int32_t a, int32_t b) {
+    const uint16_t* from = table->distances + (size_t)a * table->count;
+    const uint16_t* to = table->distances + (size_t)b * table->count;
+    int bound = 0;
+    for (int i = 0; i < table->count; i++) {
+        if (from[i] == LANDMARK_UNREACHABLE || to[i] == LANDMARK_UNREACHABLE) {
+            continue;
+        }
+        int difference = from[i] > to[i] ? from[i] - to[i] : to[i] - from[i];
+        if (difference > bound) bound = difference;
+    }
+    // Each stored distance was rounded down by up to scale - 1
+    if (bound == 0) return 0;
+    return (Cost_Typedef)bound * table->scale - (table->scale - 1);
+}
+
+#endif  // LANDMARKS_H
@@ -0,0 +1,82 @@
+#include "map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool map_create(Map_Typedef* map, int width, int height) {
+    memset(map, 0, sizeof(*map));
+    if (width <= 0 || height <= 0) return false;
+    map->barriers = calloc((size_t)width * height, sizeof(*map->barriers));
+    if (!map->barriers || !bitboard_create(&map->rows, height, width) ||
+        !bitboard_create(&map->columns, width, height)) {
+        map_destroy(map);
+        return false;
+    }
+    map->width = width;
+    map->height = height;
+    return true;
+}
+
+void map_destroy(Map_Typedef* map) {
+    free(map->barriers);
+    bitboard_destroy(&map->rows);
+    bitboard_destroy(&map->columns);
+    memset(map, 0, sizeof(*map));
+}
+
+bool map_load(Map_Typedef* map, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    // Header, "type octile", "height H" and "width W" up to the "map" line
+    int width = 0, height = 0;
+    char key[16];
+    while (fscanf(file, "%15s", key) == 1 && strcmp(key, "map") != 0) {
+        if (strcmp(key, "width") == 0) {
+            if (fscanf(file, "%d", &width) != 1) break;
+        } else if (strcmp(key, "height") == 0) {
+            if (fscanf(file, "%d", &height) != 1) break;
+        } else if (fscanf(file, "%*s") == EOF) {
+            break;
+        }
+    }
+    if (!map_create(map, width, height)) {
+        fclose(file);
+        return false;
+    }
+
+    // One row of characters per line
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int c = fgetc(file);
+            while (c == '\n' || c == '\r') c = fgetc(file);
+            if (c == EOF) {
+                map_destroy(map);
+                fclose(file);
+                return false;
+            }
+            map_set_barrier(map, x, y, !(c == '.' || c == 'G' || c == 'S'));
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool map_in_bounds(const Map_Typedef* map, int x, int y) {
+    return (x >= 0 && x < map->width && y >= 0 && y < map->height);
+}
+
+bool map_is_barrier(const Map_Typedef* map, int x, int y) {
+    if (!map_in_bounds(map, x, y)) return true;
+    return map->barriers[(size_t)y * map->width + x] != 0;
+}
+
+bool map_set_barrier(Map_Typedef* map, int x, int y, bool barrier) {
+    if (!map_in_bounds(map, x, y)) return false;
+    map->barriers[(size_t)y * map->width + x] = barrier;
+    bitboard_set(&map->rows, y, x, barrier);
+    bitboard_set(&map->columns, x, y, barrier);
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+
+// Barrier layout of a grid, shared (read-only) by every search over it
+typedef struct {
+    int width;
+    int height;
+    uint8_t* barriers;  // One byte per cell, row-major, non-zero is a barrier
+    // The same barriers packed one bit per cell, by row and by column, for
+    // scanning 64 cells at a time. Change barriers with map_set_barrier so
+    // all three stay in step
+    Bitboard_Typedef rows;
+    Bitboard_Typedef columns;
+} Map_Typedef;
+
+// Allocate an empty (barrier free) map
+bool map_create(Map_Typedef* map, int width, int height);
+
+// Free a map created with map_create or map_load
+void map_destroy(Map_Typedef* map);
+
+// Load a map in the MovingAI .map format ('.', 'G' and 'S' are passable,
+// everything else is a barrier)
+bool map_load(Map_Typedef* map, const char* path);
+
+// Check that a position lies on the map
+bool map_in_bounds(const Map_Typedef* map, int x, int y);
+
+// Check if a cell is a barrier (out of bounds cells count as barriers)
+bool map_is_barrier(const Map_Typedef* map, int x, int y);
+
+// Add or remove a barrier, returns false if the cell is out of bounds
+bool map_set_barrier(Map_Typedef* map, int x, int y, bool barrier);
+
+#endif  // MAP_H
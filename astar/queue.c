@@ -0,0 +1,274 @@
+#include "queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Check if queue is full
+static bool is_full(const Queue_Typedef* queue) {
+    return (queue->idx >= queue->capacity - 1);
+}
+
+bool queue_is_empty(const Queue_Typedef* queue) { return (queue->idx < 0); }
+
+bool queue_contains(const Queue_Typedef* queue, int32_t index) {
+    return (queue->slots[index] >= 0);
+}
+
+#if INTEGER_COSTS
+bool queue_create(Queue_Typedef* queue, int capacity) {
+    memset(queue, 0, sizeof(*queue));
+    queue->buckets = malloc(BUCKET_COUNT * sizeof(*queue->buckets));
+    queue->next = malloc((size_t)capacity * sizeof(*queue->next));
+    queue->prev = malloc((size_t)capacity * sizeof(*queue->prev));
+    queue->slots = malloc((size_t)capacity * sizeof(*queue->slots));
+    if (!queue->buckets || !queue->next || !queue->prev || !queue->slots) {
+        queue_destroy(queue);
+        return false;
+    }
+    memset(queue->buckets, -1, BUCKET_COUNT * sizeof(*queue->buckets));
+    memset(queue->slots, -1, (size_t)capacity * sizeof(*queue->slots));
+    queue->bucket_mask = BUCKET_COUNT - 1;
+    queue->capacity = capacity;
+    queue->idx = -1;
+    return true;
+}
+
+void queue_destroy(Queue_Typedef* queue) {
+    free(queue->buckets);
+    free(queue->next);
+    free(queue->prev);
+    free(queue->slots);
+    memset(queue, 0, sizeof(*queue));
+}
+
+// Every queued cell costs between min_cost and min_cost + bucket_mask, so
+// walking up from min_cost finds them all without visiting every bucket
+void queue_clear(Queue_Typedef* queue) {
+    for (Cost_Typedef cost = queue->min_cost; !queue_is_empty(queue);
+         cost++) {
+        int bucket = cost & queue->bucket_mask;
+        for (int32_t i = queue->buckets[bucket]; i >= 0; i = queue->next[i]) {
+            queue->slots[i] = -1;
+            queue->idx--;
+        }
+        queue->buckets[bucket] = -1;
+    }
+}
+
+// Remove a cell from the bucket it is filed in
+static void unlink_cell(Queue_Typedef* queue, int32_t index) {
+    int32_t prev = queue->prev[index], next = queue->next[index];
+    if (prev >= 0) {
+        queue->next[prev] = next;
+    } else {
+        queue->buckets[queue->slots[index]] = next;
+    }
+    if (next >= 0) queue->prev[next] = prev;
+}
+
+// File a cell at the front of the bucket for its cost
+static void link_cell(Queue_Typedef* queue, int32_t index, Cost_Typedef cost) {
+    int bucket = cost & queue->bucket_mask;
+    queue->slots[index] = bucket;
+    queue->prev[index] = -1;
+    queue->next[index] = queue->buckets[bucket];
+    if (queue->next[index] >= 0) queue->prev[queue->next[index]] = index;
+    queue->buckets[bucket] = index;
+}
+
+// Enlarge the ring so that f-costs spanning spread fit without wrapping onto
+// each other, refiling every queued cell
+static bool grow_buckets(Queue_Typedef* queue, Cost_Typedef spread) {
+    int old_mask = queue->bucket_mask, mask = old_mask;
+    while (mask < spread) mask = 2 * mask + 1;
+    int32_t* buckets = malloc(((size_t)mask + 1) * sizeof(*buckets));
+    if (!buckets) return false;
+    memset(buckets, -1, ((size_t)mask + 1) * sizeof(*buckets));
+
+    int32_t* old_buckets = queue->buckets;
+    queue->buckets = buckets;
+    queue->bucket_mask = mask;
+    for (int b = 0; b <= old_mask; b++) {
+        // A cell's cost is its bucket offset from min_cost in the old ring
+        Cost_Typedef cost =
+            queue->min_cost + ((b - queue->min_cost) & old_mask);
+        int32_t i = old_buckets[b];
+        while (i >= 0) {
+            int32_t next = queue->next[i];
+            link_cell(queue, i, cost);
+            i = next;
+        }
+    }
+    free(old_buckets);
+    return true;
+}
+
+// O(1) amortised
+bool queue_push(Queue_Typedef* queue, int32_t index, Cost_Typedef cost) {
+    bool queued = queue_contains(queue, index);
+    if (!queued && is_full(queue)) return false;
+
+    Cost_Typedef min_cost = cost, max_cost = cost;
+    if (!queue_is_empty(queue)) {
+        if (queue->min_cost < min_cost) min_cost = queue->min_cost;
+        if (queue->max_cost > max_cost) max_cost = queue->max_cost;
+    }
+    if (max_cost - min_cost > queue->bucket_mask &&
+        !grow_buckets(queue, max_cost - min_cost)) {
+        return false;
+    }
+    queue->min_cost = min_cost;
+    queue->max_cost = max_cost;
+
+    if (queued) {
+        unlink_cell(queue, index);
+    } else {
+        queue->idx++;
+    }
+    link_cell(queue, index, cost);
+    return true;
+}
+
+// Amortised O(1)
+bool queue_peek(Queue_Typedef* queue, Cost_Typedef* cost) {
+    if (queue_is_empty(queue)) return false;
+    while (queue->buckets[queue->min_cost & queue->bucket_mask] < 0) {
+        queue->min_cost++;
+    }
+    *cost = queue->min_cost;
+    return true;
+}
+
+// O(1)
+void queue_remove(Queue_Typedef* queue, int32_t index) {
+    if (!queue_contains(queue, index)) return;
+    unlink_cell(queue, index);
+    queue->slots[index] = -1;
+    queue->idx--;
+}
+
+// Amortised O(1)
+bool queue_pop(Queue_Typedef* queue, int32_t* index) {
+    Cost_Typedef cost;
+    if (!queue_peek(queue, &cost)) return false;
+    *index = queue->buckets[queue->min_cost & queue->bucket_mask];
+    queue_remove(queue, *index);
+    return true;
+}
+#else
+bool queue_create(Queue_Typedef* queue, int capacity) {
+    memset(queue, 0, sizeof(*queue));
+    queue->entries = malloc((size_t)capacity * sizeof(*queue->entries));
+    queue->slots = malloc((size_t)capacity * sizeof(*queue->slots));
+    if (!queue->entries || !queue->slots) {
+        queue_destroy(queue);
+        return false;
+    }
+    memset(queue->slots, -1, (size_t)capacity * sizeof(*queue->slots));
+    queue->capacity = capacity;
+    queue->idx = -1;
+    return true;
+}
+
+void queue_destroy(Queue_Typedef* queue) {
+    free(queue->entries);
+    free(queue->slots);
+    memset(queue, 0, sizeof(*queue));
+}
+
+void queue_clear(Queue_Typedef* queue) {
+    for (int i = 0; i <= queue->idx; i++) {
+        queue->slots[queue->entries[i].index] = -1;
+    }
+    queue->idx = -1;
+}
+
+// Heap ordering, lowest cost first (ties go to the cell furthest from the
+// start, which is the one closest to the target)
+static bool entry_less(const Queue_Typedef* queue, const QueueEntry_Typedef* a,
+                       const QueueEntry_Typedef* b) {
+    if (a->cost != b->cost) return a->cost < b->cost;
+    if (!queue->tie_break) return false;
+    return queue->tie_break[a->index] > queue->tie_break[b->index];
+}
+
+// Put an entry in a heap slot (keeping the cell's slot up to date)
+static void place_entry(Queue_Typedef* queue, int i,
+                        QueueEntry_Typedef entry) {
+    queue->entries[i] = entry;
+    queue->slots[entry.index] = i;
+}
+
+// Move an entry towards the root until its parent is cheaper
+static void sift_up(Queue_Typedef* queue, int i) {
+    QueueEntry_Typedef entry = queue->entries[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!entry_less(queue, &entry, &queue->entries[parent])) break;
+        place_entry(queue, i, queue->entries[parent]);
+        i = parent;
+    }
+    place_entry(queue, i, entry);
+}
+
+// Move an entry towards the leaves until both children are more expensive
+static void sift_down(Queue_Typedef* queue, int i) {
+    QueueEntry_Typedef entry = queue->entries[i];
+    while (true) {
+        int left = 2 * i + 1, right = left + 1, smallest = left;
+        if (left > queue->idx) break;
+        if (right <= queue->idx &&
+            entry_less(queue, &queue->entries[right], &queue->entries[left])) {
+            smallest = right;
+        }
+        if (!entry_less(queue, &queue->entries[smallest], &entry)) break;
+        place_entry(queue, i, queue->entries[smallest]);
+        i = smallest;
+    }
+    place_entry(queue, i, entry);
+}
+
+// Kept in heap order, O(log n)
+bool queue_push(Queue_Typedef* queue, int32_t index, Cost_Typedef cost) {
+    if (queue_contains(queue, index)) {
+        queue->entries[queue->slots[index]].cost = cost;
+        sift_up(queue, queue->slots[index]);
+        sift_down(queue, queue->slots[index]);
+        return true;
+    }
+    if (is_full(queue)) return false;
+    QueueEntry_Typedef entry = {.cost = cost, .index = index};
+    place_entry(queue, ++queue->idx, entry);
+    sift_up(queue, queue->idx);
+    return true;
+}
+
+// O(1)
+bool queue_peek(Queue_Typedef* queue, Cost_Typedef* cost) {
+    if (queue_is_empty(queue)) return false;
+    *cost = queue->entries[0].cost;
+    return true;
+}
+
+// O(log n)
+void queue_remove(Queue_Typedef* queue, int32_t index) {
+    if (!queue_contains(queue, index)) return;
+    int i = queue->slots[index];
+    queue->slots[index] = -1;
+    if (i < queue->idx--) {
+        // Fill the hole with the last entry, which may belong either side
+        int32_t moved = queue->entries[queue->idx + 1].index;
+        place_entry(queue, i, queue->entries[queue->idx + 1]);
+        sift_up(queue, i);
+        sift_down(queue, queue->slots[moved]);
+    }
+}
+
+// O(log n)
+bool queue_pop(Queue_Typedef* queue, int32_t* index) {
+    if (queue_is_empty(queue)) return false;
+    *index = queue->entries[0].index;
+    queue_remove(queue, *index);
+    return true;
+}
+#endif
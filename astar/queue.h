@@ -0,0 +1,79 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cost.h"
+
+#if INTEGER_COSTS
+// Initial number of f-cost buckets in the open queue. With a consistent
+// heuristic every queued cell costs at most 2 * 14 more than the cheapest one
+// when expanding single steps, so the buckets can be reused circularly. Longer
+// moves (jumps) grow the ring to fit
+#define BUCKET_COUNT 32
+
+// Queue for open cells (circular buckets of cell ids indexed by cost, each
+// bucket a doubly-linked list threaded through next/prev)
+typedef struct {
+    int32_t* buckets;  // First cell of each bucket, -1 if empty
+    int bucket_mask;   // Number of buckets - 1 (a power of two - 1)
+    int32_t* next;
+    int32_t* prev;
+    int32_t* slots;  // Bucket of each cell, -1 when not queued
+    Cost_Typedef min_cost;
+    Cost_Typedef max_cost;
+    int capacity;
+    int idx;
+} Queue_Typedef;
+#else
+// Entry in the open queue
+typedef struct {
+    Cost_Typedef cost;  // f-cost
+    int32_t index;      // Cell id
+} QueueEntry_Typedef;
+
+// Queue for open cells (indexed binary min-heap of (f-cost, cell id) pairs)
+typedef struct {
+    QueueEntry_Typedef* entries;
+    int32_t* slots;  // Heap index of each cell, -1 when not queued
+    // g-cost of each cell, on equal f-costs the cell furthest from the start
+    // (so closest to the target) is popped first. May be NULL
+    const Cost_Typedef* tie_break;
+    int capacity;
+    int idx;
+} Queue_Typedef;
+#endif
+
+// Allocate a queue for cell ids 0 .. capacity - 1
+bool queue_create(Queue_Typedef* queue, int capacity);
+
+// Free a queue created with queue_create
+void queue_destroy(Queue_Typedef* queue);
+
+// Remove every queued cell (only touches the cells still queued)
+void queue_clear(Queue_Typedef* queue);
+
+// Check if the queue is empty
+bool queue_is_empty(const Queue_Typedef* queue);
+
+// Check if a cell is currently queued
+bool queue_contains(const Queue_Typedef* queue, int32_t index);
+
+// Queue a cell with an f-cost. A cell that is already queued is moved in place
+// to its new cost (up or down) rather than queued twice. Returns false if the
+// cell couldn't be queued (out of memory), the caller must not carry on as if
+// it had been
+bool queue_push(Queue_Typedef* queue, int32_t index, Cost_Typedef cost);
+
+// Take a cell off the queue wherever it is (nothing happens if it isn't
+// queued)
+void queue_remove(Queue_Typedef* queue, int32_t index);
+
+// Get the cost of the cheapest cell without removing it
+bool queue_peek(Queue_Typedef* queue, Cost_Typedef* cost);
+
+// Get the cheapest cell off the queue (and remove it)
+bool queue_pop(Queue_Typedef* queue, int32_t* index);
+
+#endif  // QUEUE_H
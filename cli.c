@@ -0,0 +1,321 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "astar.h"
+#include "batch.h"
+
+// Longest line read from a scenario file
+#define LINE_SIZE 4096
+// Cost of a diagonal move in cells, as in the optimal lengths of .scen files
+#define DIAGONAL_COST 1.4142135623730951
+
+// Queries read from a scenario file
+typedef struct {
+    PathQuery_Typedef* queries;
+    double* optimal;  // Path length given by the scenario, negative if none
+    int count;
+    int capacity;
+} Scenario_Typedef;
+
+// Command line
+void usage(const char* program);
+bool parse_count(const char* text, int* count);
+
+// Scenario files
+bool scenario_load(Scenario_Typedef* scenario, const char* path);
+bool scenario_add(Scenario_Typedef* scenario, PathQuery_Typedef query,
+                  double optimal);
+void scenario_destroy(Scenario_Typedef* scenario);
+
+// Path cost in cells, walking the moves of a path (one cell each)
+double octile_cost(const Path_Typedef* path);
+
+// Wall clock time in seconds
+double now();
+
+int main(int argc, char* argv[]) {
+    ExpandMode_Typedef mode = EXPAND_ASTAR;
+    const char* map_path = NULL;
+    const char* scenario_path = NULL;
+    const char* output_path = NULL;
+    const char* landmarks_path = NULL;
+    int worker_count = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = (value != NULL);
+        if (ok && strcmp(argv[i], "-a") == 0) {
+            if (strcmp(value, "astar") == 0) {
+                mode = EXPAND_ASTAR;
+            } else if (strcmp(value, "jps") == 0) {
+                mode = EXPAND_JPS;
+            } else if (strcmp(value, "jps+") == 0) {
+                mode = EXPAND_JPS_PLUS;
+            } else if (strcmp(value, "bidir") == 0) {
+                mode = EXPAND_BIDIRECTIONAL;
+            } else {
+                ok = false;
+            }
+        } else if (ok && strcmp(argv[i], "-m") == 0) {
+            map_path = value;
+        } else if (ok && strcmp(argv[i], "-q") == 0) {
+            scenario_path = value;
+        } else if (ok && strcmp(argv[i], "-o") == 0) {
+            output_path = value;
+        } else if (ok && strcmp(argv[i], "-l") == 0) {
+            landmarks_path = value;
+        } else if (ok && strcmp(argv[i], "-j") == 0) {
+            ok = parse_count(value, &worker_count);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (!map_path || !scenario_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Map_Typedef map;
+    if (!map_load(&map, map_path)) {
+        fprintf(stderr, "Error loading map: %s\n", map_path);
+        return 1;
+    }
+    Scenario_Typedef scenario = {0};
+    if (!scenario_load(&scenario, scenario_path)) {
+        fprintf(stderr, "Error loading scenario: %s\n", scenario_path);
+        return 1;
+    }
+    FILE* output = output_path ? fopen(output_path, "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "Error opening output: %s\n", output_path);
+        return 1;
+    }
+
+    JumpTable_Typedef jump_table = {0};
+    LandmarkTable_Typedef landmarks = {0};
+    Components_Typedef components;
+    PathResult_Typedef* results = calloc(scenario.count, sizeof(*results));
+    double* times = calloc(scenario.count, sizeof(*times));
+    bool allocated = scenario.count == 0 || (results && times);
+    if (!components_create(&components, &map) || !allocated) {
+        fprintf(stderr, "Error allocating the search for a %dx%d map\n",
+                map.width, map.height);
+        return 1;
+    }
+    if (mode == EXPAND_JPS_PLUS && !jump_table_create(&jump_table, &map)) {
+        fprintf(stderr, "Error building the jump table\n");
+        return 1;
+    }
+    if (landmarks_path && !landmarks_load(&landmarks, &map, landmarks_path)) {
+        if (!landmarks_create(&landmarks, &map, LANDMARK_COUNT)) {
+            fprintf(stderr, "Error building the landmark distances\n");
+            return 1;
+        }
+        if (!landmarks_save(&landmarks, landmarks_path)) {
+            fprintf(stderr, "Error saving landmarks: %s\n", landmarks_path);
+        }
+    }
+
+    // Answer the queries one at a time, timing each, or spread them over
+    // worker threads (only the whole batch is timed then)
+    double begin = now();
+    if (worker_count == 1) {
+        AStarContext_Typedef ctx;
+        if (!astar_create(&ctx, &map)) {
+            fprintf(stderr, "Error allocating the search for a %dx%d map\n",
+                    map.width, map.height);
+            return 1;
+        }
+        ctx.mode = mode;
+        // Unreachable targets are answered without a search
+        ctx.components = &components;
+        ctx.jump_table = (mode == EXPAND_JPS_PLUS) ? &jump_table : NULL;
+        ctx.landmarks = landmarks_path ? &landmarks : NULL;
+        for (int i = 0; i < scenario.count; i++) {
+            PathQuery_Typedef* query = &scenario.queries[i];
+            PathResult_Typedef* result = &results[i];
+            double query_begin = now();
+            result->found =
+                astar_find_path(&ctx, query->start, query->target, NULL);
+            times[i] = now() - query_begin;
+            result->expanded_count = ctx.expanded_count;
+            if (result->found) astar_get_path(&ctx, &result->path);
+        }
+        astar_destroy(&ctx);
+    } else {
+        BatchPool_Typedef pool;
+        if (!batch_create(&pool, &map, worker_count)) {
+            fprintf(stderr, "Error starting %d workers\n", worker_count);
+            return 1;
+        }
+        pool.mode = mode;
+        pool.components = &components;
+        pool.jump_table = (mode == EXPAND_JPS_PLUS) ? &jump_table : NULL;
+        pool.landmarks = landmarks_path ? &landmarks : NULL;
+        batch_find_paths(&pool, scenario.queries, results, scenario.count,
+                         true);
+        batch_destroy(&pool);
+    }
+    double total_time = now() - begin;
+
+    // One row per query. Costs are in cells (1 straight, sqrt(2) diagonal,
+    // as optimal), length counts the cells on the path
+    fprintf(output,
+            "query,start_x,start_y,target_x,target_y,found,length,cost,"
+            "expanded,time_ms,optimal\n");
+    int found_count = 0;
+    for (int i = 0; i < scenario.count; i++) {
+        PathQuery_Typedef* query = &scenario.queries[i];
+        PathResult_Typedef* result = &results[i];
+        fprintf(output, "%d,%d,%d,%d,%d,%d,", i, query->start.x,
+                query->start.y, query->target.x, query->target.y,
+                result->found);
+        if (result->found) {
+            found_count++;
+            fprintf(output, "%d,%.4f,", result->path.length,
+                    octile_cost(&result->path));
+        } else {
+            fprintf(output, ",,");
+        }
+        fprintf(output, "%d,", result->expanded_count);
+        if (worker_count == 1) {
+            fprintf(output, "%.4f", times[i] * 1000.0);
+        }
+        fprintf(output, ",");
+        if (scenario.optimal[i] >= 0) {
+            fprintf(output, "%.4f", scenario.optimal[i]);
+        }
+        fprintf(output, "\n");
+        astar_free_path(&result->path);
+    }
+    fprintf(stderr, "%d of %d paths found in %.3f ms\n", found_count,
+            scenario.count, total_time * 1000.0);
+
+    if (output != stdout) {
+        fclose(output);
+    }
+    free(results);
+    free(times);
+    jump_table_destroy(&jump_table);
+    landmarks_destroy(&landmarks);
+    components_destroy(&components);
+    scenario_destroy(&scenario);
+    map_destroy(&map);
+    return 0;
+}
+
+void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s -m map_file -q scenario_file [-o output.csv] "
+            "[-a astar|jps|jps+|bidir] [-l landmark_file] [-j workers]\n"
+            "The scenario is a MovingAI .scen file, or one \"start_x start_y "
+            "target_x target_y\" query per line. One worker (the default) "
+            "times each query, more (0 for one per core) answer them in "
+            "parallel and only time the whole batch\n",
+            program);
+}
+
+// Read a whole number of zero or more, nothing may follow it
+bool parse_count(const char* text, int* count) {
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < 0 ||
+        value > INT_MAX) {
+        return false;
+    }
+    *count = (int)value;
+    return true;
+}
+
+// Read the queries of a MovingAI .scen file ("version" line, then bucket,
+// map, map width and height, start, target and optimal length per line) or
+// a plain list of "start_x start_y target_x target_y" lines
+bool scenario_load(Scenario_Typedef* scenario, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[LINE_SIZE];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        PathQuery_Typedef query;
+        double optimal = -1;
+        char first[16];
+        if (sscanf(line, "%15s", first) != 1 ||
+            strcmp(first, "version") == 0) {
+            continue;  // Blank line or .scen header
+        }
+        if (sscanf(line, "%*d %*s %*d %*d %d %d %d %d %lf", &query.start.x,
+                   &query.start.y, &query.target.x, &query.target.y,
+                   &optimal) != 5 &&
+            sscanf(line, "%d %d %d %d", &query.start.x, &query.start.y,
+                   &query.target.x, &query.target.y) != 4) {
+            fprintf(stderr, "%s:%d: not a query\n", path, line_number);
+            ok = false;
+            break;
+        }
+        ok = scenario_add(scenario, query, optimal);
+    }
+
+    fclose(file);
+    if (!ok) scenario_destroy(scenario);
+    return ok;
+}
+
+bool scenario_add(Scenario_Typedef* scenario, PathQuery_Typedef query,
+                  double optimal) {
+    if (scenario->count == scenario->capacity) {
+        int capacity = scenario->capacity ? 2 * scenario->capacity : 64;
+        PathQuery_Typedef* queries = realloc(
+            scenario->queries, (size_t)capacity * sizeof(*queries));
+        if (!queries) return false;
+        scenario->queries = queries;
+        double* lengths =
+            realloc(scenario->optimal, (size_t)capacity * sizeof(*lengths));
+        if (!lengths) return false;
+        scenario->optimal = lengths;
+        scenario->capacity = capacity;
+    }
+    scenario->queries[scenario->count] = query;
+    scenario->optimal[scenario->count] = optimal;
+    scenario->count++;
+    return true;
+}
+
+void scenario_destroy(Scenario_Typedef* scenario) {
+    free(scenario->queries);
+    free(scenario->optimal);
+    memset(scenario, 0, sizeof(*scenario));
+}
+
+double octile_cost(const Path_Typedef* path) {
+    int straight = 0, diagonal = 0;
+    for (int i = 1; i < path->length; i++) {
+        // Consecutive cells are neighbours
+        if (path->cells[i].x != path->cells[i - 1].x &&
+            path->cells[i].y != path->cells[i - 1].y) {
+            diagonal++;
+        } else {
+            straight++;
+        }
+    }
+    return straight + diagonal * DIAGONAL_COST;
+}
+
+double now() {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
@@ -1,28 +1,35 @@
 #include <SDL.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar.h"
+#include "search_thread.h"
+#include "view.h"
 
 // Window size, equal x and y
 #define WINDOW_SIZE 720
-#define CELL_COUNT 40
-#define CELL_SIZE (WINDOW_SIZE / CELL_COUNT)
-
-// A* Constants
-// (Theoretical) Number of neighbours around each cell
-#define NEIGHBOURS_COUNT 8
-// Max size of queue
-#define QUEUE_SIZE (CELL_COUNT * CELL_COUNT)
 
-// Adjust these to adjust the start and end positions
+// Defaults, each can be overridden on the command line (see usage())
+// Size of the random map, equal x and y
+#define CELL_COUNT 40
 // Starting cell
-#define START_X 3  // Must be less than CELL_COUNT
-#define START_Y 8  // Must be less than CELL_COUNT
+#define START_X 3  // Must be on the map
+#define START_Y 8  // Must be on the map
 // Target cell
-#define TARGET_X 38  // Must be less than CELL_COUNT
-#define TARGET_Y 38  // Must be less than CELL_COUNT
+#define TARGET_X 38  // Must be on the map
+#define TARGET_Y 38  // Must be on the map
+// Cells expanded per rendered frame, 0 runs the search flat out
+#define EXPANSIONS_PER_FRAME 1
+// Arrow keys pan by this fraction of the window
+#define PAN_FRACTION 8
 
 // Window utilities
 SDL_Renderer* renderer = NULL;
 SDL_Window* window = NULL;
+bool vsync = false;  // Presenting waits for the display
 
 // Window function
 bool window_init();
@@ -32,337 +39,314 @@ bool window_mainloop();
 // Draw functions
 void draw_window();
 void draw_cells();
-void draw_grid();
+void draw_path();
+void report_search();
 void create_barriers(int n_barriers);
-bool set_cell_colour(int x, int y);
-
-// Cell state
-typedef enum {
-    CELL_EMPTY,
-    CELL_START,
-    CELL_BARRIER,
-    CELL_VISITED,
-    CELL_NEIGHBOUR,
-    CELL_PATH,
-    CELL_TARGET
-} CellState_Typedef;
-
-// Position of a cell
-typedef struct {
-    int x;
-    int y;
-} CellPosition_Typedef;
-
-// All information about a cell
-typedef struct {
-    CellPosition_Typedef position;
-    double h_cost;
-    double g_cost;
-    double cost;
-    CellState_Typedef state;
-    CellPosition_Typedef parent_position;
-} Cell_Typedef;
-
-// Queue for open cells
-typedef struct {
-    Cell_Typedef cells[QUEUE_SIZE];
-    int idx;
-} Queue_Typedef;
-
-// Grid of state for each cell
-Cell_Typedef grid[CELL_COUNT][CELL_COUNT];
-
-// Nodes to be evaluated (queue)
-Queue_Typedef open_nodes_queue = {.idx = -1};
-
-// Already evaluated nodes (just an array)
-int closed_nodes_count = 0;
-Cell_Typedef closed_nodes[QUEUE_SIZE];
-
-// Flag for when the target is found
-bool found_target = false;
-
-// Some queue actions
-// Check if queue is full
-bool is_full(Queue_Typedef* queue) { return (queue->idx > QUEUE_SIZE - 1); }
-// Check if the queue is empty
-bool is_empty(Queue_Typedef* queue) { return (queue->idx < 0); }
-// Queue a cell (end of queue)
-void enqueue(Queue_Typedef* queue, Cell_Typedef cell) {
-    if (is_full(queue)) return;
-    queue->cells[++queue->idx] = cell;
-}
-// Get an item off the queue (and "remove")
-bool pop(Queue_Typedef* queue, Cell_Typedef* cell) {
-    if (is_empty(queue)) return false;
-    *cell = queue->cells[queue->idx--];
-    return true;
-}
-
-// Util functions
-// Used in qsort to sort from largest to smallest cost (smallest is popped
-// first)
-int compare_cell_cost(const void* a, const void* b) {
-    Cell_Typedef* qA = (Cell_Typedef*)a;
-    Cell_Typedef* qB = (Cell_Typedef*)b;
-    return (qA->cost < qB->cost) ? 1 : (qA->cost > qB->cost) ? -1 : 0;
-}
-
-// Distance between neighbouring cells
-// 14 is roughly sqrt(2) - diagonal
-// 10 is adjacent squares
-double compute_distance(int x1, int y1, int x2, int y2) {
-    double dx = abs(x1 - x2);
-    double dy = abs(y1 - y2);
-    if (dx > dy) return 14 * dy + 10 * (dx - dy);
-    return 14 * dx + 10 * (dy - dx);
-}
-
-// Distance from start to some cell
-double g(int x1, int y1) { return compute_distance(x1, y1, START_X, START_Y); }
-
-// Distance from target to some cell
-double h(int x1, int y1) {
-    return compute_distance(x1, y1, TARGET_X, TARGET_Y);
-}
-
-// One target found the path is drawn
-void draw_path(Cell_Typedef* current_cell) {
-    int force_stop = 0;
-    Cell_Typedef tmp_cell =
-        grid[current_cell->position.x][current_cell->position.y];
-    while (force_stop < 1000) {  // Limit is arbitrary (but should not be)
-        grid[tmp_cell.position.x][tmp_cell.position.y].state = CELL_PATH;
-        tmp_cell = grid[tmp_cell.parent_position.x][tmp_cell.parent_position.y];
-        if (tmp_cell.parent_position.x == -1 &&
-            tmp_cell.parent_position.y == -1) {
-            break;  // Back at start
+void handle_event(const SDL_Event* event);
+
+// Command line
+void usage(const char* program);
+bool parse_count(const char* text, int* count);
+bool parse_position(const char* text, CellPosition_Typedef* position);
+
+// The map and search being shown
+Map_Typedef map;
+AStarContext_Typedef ctx;
+JumpTable_Typedef jump_table;  // Only built for -a jps+
+LandmarkTable_Typedef landmarks;  // Only loaded or built for -l
+Components_Typedef components;
+// Zoomable picture of the search. Only the cells the search changed are
+// picked up each frame
+View_Typedef view;
+// The search runs on its own thread, handing over the cells it changes
+SearchThread_Typedef search;
+
+int main(int argc, char* argv[]) {
+    int expansions_per_frame = EXPANSIONS_PER_FRAME;
+    ExpandMode_Typedef mode = EXPAND_ASTAR;
+    int width = CELL_COUNT, height = CELL_COUNT;
+    const char* map_path = NULL;
+    const char* landmarks_path = NULL;
+    CellPosition_Typedef start = {.x = START_X, .y = START_Y};
+    CellPosition_Typedef target = {.x = TARGET_X, .y = TARGET_Y};
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = (value != NULL);
+        if (ok && strcmp(argv[i], "-a") == 0) {
+            if (strcmp(value, "astar") == 0) {
+                mode = EXPAND_ASTAR;
+            } else if (strcmp(value, "jps") == 0) {
+                mode = EXPAND_JPS;
+            } else if (strcmp(value, "jps+") == 0) {
+                mode = EXPAND_JPS_PLUS;
+            } else if (strcmp(value, "bidir") == 0) {
+                mode = EXPAND_BIDIRECTIONAL;
+            } else {
+                ok = false;
+            }
+        } else if (ok && strcmp(argv[i], "-e") == 0) {
+            ok = parse_count(value, &expansions_per_frame);
+        } else if (ok && strcmp(argv[i], "-m") == 0) {
+            map_path = value;
+        } else if (ok && strcmp(argv[i], "-l") == 0) {
+            landmarks_path = value;
+        } else if (ok && strcmp(argv[i], "-s") == 0) {
+            ok = (sscanf(value, "%dx%d", &width, &height) == 2);
+        } else if (ok && strcmp(argv[i], "-f") == 0) {
+            ok = parse_position(value, &start);
+        } else if (ok && strcmp(argv[i], "-t") == 0) {
+            ok = parse_position(value, &target);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
         }
-        force_stop++;
+        i++;
     }
-}
-
-// A*
-void a_star() {
-    Cell_Typedef current_cell;
 
-    // Stop if already found target
-    if (found_target) {
-        return;
+    if (map_path) {
+        if (!map_load(&map, map_path)) {
+            printf("Error loading map: %s\n", map_path);
+            return 1;
+        }
+    } else {
+        if (!map_create(&map, width, height)) {
+            printf("Error creating a %dx%d map\n", width, height);
+            return 1;
+        }
+        // Same density as 1000 barriers on the original 40x40 grid
+        create_barriers(width * height / 8 * 5);
+        // Keep the start and target free
+        map_set_barrier(&map, start.x, start.y, false);
+        map_set_barrier(&map, target.x, target.y, false);
     }
 
-    // Get the current cell (lowest f-score off the queue)
-    if (!pop(&open_nodes_queue, &current_cell)) {
-        return;
+    if (!astar_create(&ctx, &map)) {
+        printf("Error allocating the search for a %dx%d map\n", map.width,
+               map.height);
+        return 1;
     }
-
-    // Add current node to the list of closed nodes
-    closed_nodes[closed_nodes_count++] = current_cell;
-
-    // Get the x and y position of the current cell
-    int x = current_cell.position.x, y = current_cell.position.y;
-
-    // Set the current cell colour to a travelled cell colour
-    if (grid[x][y].state != CELL_START) {
-        grid[x][y].state = CELL_VISITED;
+    ctx.mode = mode;
+    // Walled off targets are reported straight away
+    if (!components_create(&components, &map)) {
+        printf("Error labelling the map\n");
+        return 1;
     }
-
-    // Get the positions of all 8 neighbours around the current cell
-    CellPosition_Typedef neighbours[NEIGHBOURS_COUNT] = {
-        {.x = x - 1, .y = y - 1}, {.x = x + 1, .y = y + 1},
-        {.x = x + 1, .y = y - 1}, {.x = x - 1, .y = y + 1},
-        {.x = x + 1, .y = y},     {.x = x - 1, .y = y},
-        {.x = x, .y = y - 1},     {.x = x, .y = y + 1},
-    };
-
-    // Assess each of the neighbours
-    for (int n = 0; n < NEIGHBOURS_COUNT; n++) {
-        // Get a neighbour
-        CellPosition_Typedef neighbour = neighbours[n];
-        if (neighbour.x < 0 || neighbour.x > CELL_COUNT - 1 ||
-            neighbour.y < 0 || neighbour.y > CELL_COUNT - 1) {
-            continue;  // Skip out of bounds neighbours
+    ctx.components = &components;
+    if (mode == EXPAND_JPS_PLUS) {
+        if (!jump_table_create(&jump_table, &map)) {
+            printf("Error building the jump table\n");
+            return 1;
         }
-
-        // Check if the neighbour is the target
-        if (grid[neighbour.x][neighbour.y].state == CELL_TARGET) {
-            found_target = true;
-            draw_path(&current_cell);
-            return;
-        }
-
-        // Check if the neighbour is a barrier
-        if (grid[neighbour.x][neighbour.y].state == CELL_BARRIER) {
-            continue;
-        }
-
-        // Check if the neighbour is already visited
-        bool is_closed = false;
-        for (int c = 0; c < closed_nodes_count; c++) {
-            if (closed_nodes[c].position.x == neighbour.x &&
-                closed_nodes[c].position.y == neighbour.y) {
-                is_closed = true;
-                break;
+        ctx.jump_table = &jump_table;
+    }
+    if (landmarks_path) {
+        // Built once per map, later runs load the saved distances
+        if (!landmarks_load(&landmarks, &map, landmarks_path)) {
+            if (!landmarks_create(&landmarks, &map, LANDMARK_COUNT)) {
+                printf("Error building the landmark distances\n");
+                return 1;
             }
-        }
-        if (is_closed) {
-            continue;
-        }
-
-        // Check if neighbour is in the queue
-        bool in_queue = false;
-        for (int o = 0; o < open_nodes_queue.idx; o++) {
-            if (open_nodes_queue.cells[o].position.x == neighbour.x &&
-                open_nodes_queue.cells[o].position.y == neighbour.y) {
-                in_queue = true;
-                break;
+            if (!landmarks_save(&landmarks, landmarks_path)) {
+                printf("Error saving landmarks: %s\n", landmarks_path);
             }
         }
-
-        // Calculate the g-cost (distance from the start) plus the cost of
-        // the current cell
-        double neighbour_g =
-            current_cell.g_cost + compute_distance(current_cell.position.x,
-                                                   current_cell.position.y,
-                                                   neighbour.x, neighbour.y);
-
-        // Check if the neighbour is not in the queue or its g-cost is lower
-        // than the current g-cost if so, add it to the queue
-        if (!in_queue || neighbour_g <= g(neighbour.x, neighbour.y)) {
-            grid[neighbour.x][neighbour.y].position.x = neighbour.x;
-            grid[neighbour.x][neighbour.y].position.y = neighbour.y;
-            grid[neighbour.x][neighbour.y].g_cost = neighbour_g;
-            grid[neighbour.x][neighbour.y].h_cost = h(neighbour.x, neighbour.y);
-            grid[neighbour.x][neighbour.y].cost =
-                neighbour_g + h(neighbour.x, neighbour.y);
-            grid[neighbour.x][neighbour.y].parent_position.x =
-                current_cell.position.x;
-            grid[neighbour.x][neighbour.y].parent_position.y =
-                current_cell.position.y;
-            if (grid[neighbour.x][neighbour.y].state == CELL_EMPTY) {
-                grid[neighbour.x][neighbour.y].state = CELL_NEIGHBOUR;
-            }
-            enqueue(&open_nodes_queue, grid[neighbour.x][neighbour.y]);
-        }
+        ctx.landmarks = &landmarks;
+    }
+    if (!astar_begin(&ctx, start, target)) {
+        printf("Start and target must be free cells on the map\n");
+        return 1;
     }
 
-    // Sort the queue by f-cost
-    qsort(open_nodes_queue.cells, open_nodes_queue.idx + 1,
-          sizeof(Cell_Typedef), compare_cell_cost);
-}
-
-int main() {
     if (!window_init()) {
         return 1;
     }
 
-    // Start Cell
-    grid[START_X][START_Y].state = CELL_START;
-    grid[START_X][START_Y].position.x = START_X;
-    grid[START_X][START_Y].position.y = START_Y;
-    grid[START_X][START_Y].g_cost = g(START_X, START_Y);
-    grid[START_X][START_Y].h_cost = h(START_X, START_Y);
-    grid[START_X][START_Y].cost =
-        grid[START_X][START_Y].g_cost + grid[START_X][START_Y].h_cost;
-    grid[START_X][START_Y].parent_position.x = -1;
-    grid[START_X][START_Y].parent_position.y = -1;
-    enqueue(&open_nodes_queue, grid[START_X][START_Y]);
-
-    // End cell
-    grid[TARGET_X][TARGET_Y].state = CELL_TARGET;
-    grid[TARGET_X][TARGET_Y].position.x = TARGET_X;
-    grid[TARGET_X][TARGET_Y].position.y = TARGET_Y;
-
-    create_barriers(1000);
+    // Every cell as the search starts, from then on the search thread hands
+    // over the cells it changes
+    view_refresh_all(&view);
+    if (!search_thread_start(&search, &ctx, expansions_per_frame)) {
+        printf("Error starting the search thread\n");
+        return 1;
+    }
 
     while (window_mainloop()) {
-        a_star();
-        SDL_Delay(10);
+        search_thread_frame(&search);
+        if (!vsync) {
+            SDL_Delay(10);
+        }
     }
 
+    search_thread_stop(&search);
     window_kill();
+    astar_destroy(&ctx);
+    jump_table_destroy(&jump_table);
+    landmarks_destroy(&landmarks);
+    components_destroy(&components);
+    map_destroy(&map);
     return 0;
 }
 
-bool set_cell_colour(int x, int y) {
-    if (x < 0 || x > CELL_COUNT - 1 || y < 0 || y > CELL_COUNT - 1) {
-        return false;  // Invalid range
+void usage(const char* program) {
+    printf("Usage: %s [-m map_file | -s WIDTHxHEIGHT] [-f X,Y] [-t X,Y] "
+           "[-e expansions_per_frame] [-a astar|jps|jps+|bidir] "
+           "[-l landmark_file]\n"
+           "Wheel or +/- zooms, dragging or the arrow keys pan, 0 fits the "
+           "map in the window\n",
+           program);
+}
+
+// Read a whole number of zero or more, nothing may follow it
+bool parse_count(const char* text, int* count) {
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < 0 ||
+        value > INT_MAX) {
+        return false;
     }
+    *count = (int)value;
+    return true;
+}
 
-    switch (grid[x][y].state) {
-        case CELL_EMPTY:
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            break;
-        case CELL_START:
-            SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-            break;
-        case CELL_BARRIER:
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            break;
-        case CELL_PATH:
-            SDL_SetRenderDrawColor(renderer, 255, 50, 0, 255);
-            break;
-        case CELL_VISITED:
-            SDL_SetRenderDrawColor(renderer, 0, 180, 0, 255);
-            break;
-        case CELL_NEIGHBOUR:
-            SDL_SetRenderDrawColor(renderer, 255, 234, 0, 255);
-            break;
-        case CELL_TARGET:
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-            break;
-        default:
-            return false;
+// Read an "x,y" pair
+bool parse_position(const char* text, CellPosition_Typedef* position) {
+    return (sscanf(text, "%d,%d", &position->x, &position->y) == 2);
+}
+
+// Report the search once it has finished (which may be before the first
+// expansion), the context is the viewer's again by then
+void report_search() {
+    static bool reported = false;
+    if (reported) {
+        return;
     }
+    reported = true;
 
-    return true;
+    if (search.overflowed) {
+        view_refresh_all(&view);
+    }
+    if (ctx.status == SEARCH_FOUND) {
+        draw_path();
+    }
+    const char* outcome = ctx.status == SEARCH_FOUND    ? "Path found"
+                          : ctx.status == SEARCH_FAILED ? "Out of memory"
+                                                        : "No path";
+    printf("%s after %d expansions in %.3f ms\n", outcome, ctx.expanded_count,
+           search.search_ticks * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+// One target found the path is drawn
+void draw_path() {
+    // Every cell between the target and the start (parents never loop, so
+    // this ends however long the path is)
+    int32_t target = astar_cell_id(&ctx, ctx.target.x, ctx.target.y);
+    for (int32_t id = ctx.parent[target]; id != -1 && ctx.parent[id] != -1;
+         id = ctx.parent[id]) {
+        ctx.state[id] = CELL_PATH;
+        view_refresh_cell(&view, id);
+    }
 }
 
 void create_barriers(int n_barriers) {
     int n_created = 0;
     srand(time(NULL));
     while (n_created < n_barriers) {
-        int rand_x = rand() % CELL_COUNT;
-        int rand_y = rand() % CELL_COUNT;
-        if (grid[rand_x][rand_y].state != CELL_START &&
-            grid[rand_x][rand_y].state != CELL_TARGET) {
-            grid[rand_x][rand_y].state = CELL_BARRIER;
-            n_created++;
-        }
+        int rand_x = rand() % map.width;
+        int rand_y = rand() % map.height;
+        map_set_barrier(&map, rand_x, rand_y, true);
+        n_created++;
     }
 }
 
 void draw_cells() {
-    for (int x = 0; x < CELL_COUNT; x++) {
-        for (int y = 0; y < CELL_COUNT; y++) {
-            SDL_Rect cell = {.x = x * CELL_SIZE,
-                             .y = y * CELL_SIZE,
-                             .w = CELL_SIZE,
-                             .h = CELL_SIZE};
-            set_cell_colour(x, y);
-            SDL_RenderFillRect(renderer, &cell);
+    // A finished search has handed over all its changes, so check before
+    // taking them
+    bool finished = search_thread_finished(&search);
+
+    // What the ring holds now, in at most two runs (before and after it
+    // wraps)
+    for (int run = 0; run < 2; run++) {
+        const CellChange_Typedef* changes;
+        int count = search_thread_take(&search, &changes);
+        for (int i = 0; i < count; i++) {
+            view_set_cell(&view, changes[i].id, changes[i].state);
         }
+        search_thread_release(&search, count);
     }
-}
 
-void draw_grid() {
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-    for (uint16_t offset = 0; offset < WINDOW_SIZE; offset += CELL_SIZE) {
-        SDL_RenderDrawLine(renderer, offset, 0, offset, 720);
-        SDL_RenderDrawLine(renderer, 0, offset, 720, offset);
+    if (finished) {
+        report_search();
     }
+    view_draw(&view);
 }
 
 void draw_window() {
     draw_cells();
-    draw_grid();
+}
+
+// Zoom and pan with the mouse and keyboard, follow window resizes
+void handle_event(const SDL_Event* event) {
+    int x, y;
+    switch (event->type) {
+        case SDL_MOUSEWHEEL:
+            SDL_GetMouseState(&x, &y);
+            view_zoom(&view, event->wheel.y, x, y);
+            break;
+        case SDL_MOUSEMOTION:
+            if (event->motion.state & SDL_BUTTON_LMASK) {
+                view_pan(&view, event->motion.xrel, event->motion.yrel);
+            }
+            break;
+        case SDL_KEYDOWN:
+            switch (event->key.keysym.sym) {
+                case SDLK_EQUALS:
+                case SDLK_PLUS:
+                    view_zoom(&view, 1, view.window_width / 2,
+                              view.window_height / 2);
+                    break;
+                case SDLK_MINUS:
+                    view_zoom(&view, -1, view.window_width / 2,
+                              view.window_height / 2);
+                    break;
+                case SDLK_0:
+                    view_fit(&view);
+                    break;
+                case SDLK_LEFT:
+                    view_pan(&view, view.window_width / PAN_FRACTION, 0);
+                    break;
+                case SDLK_RIGHT:
+                    view_pan(&view, -view.window_width / PAN_FRACTION, 0);
+                    break;
+                case SDLK_UP:
+                    view_pan(&view, 0, view.window_height / PAN_FRACTION);
+                    break;
+                case SDLK_DOWN:
+                    view_pan(&view, 0, -view.window_height / PAN_FRACTION);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case SDL_WINDOWEVENT:
+            if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                SDL_GetRendererOutputSize(renderer, &x, &y);
+                view_resize(&view, x, y);
+            }
+            break;
+        default:
+            break;
+    }
 }
 
 bool window_mainloop() {
     SDL_Event event;
 
-    // Clear window
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    // Clear window, grey around the edges of the map
+    SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
     SDL_RenderClear(renderer);
 
     // Check for exit event
@@ -371,6 +355,7 @@ bool window_mainloop() {
             case SDL_QUIT:
                 return false;
             default:
+                handle_event(&event);
                 break;
         }
     }
@@ -391,20 +376,34 @@ bool window_init() {
 
     window = SDL_CreateWindow("A-Star", SDL_WINDOWPOS_UNDEFINED,
                               SDL_WINDOWPOS_UNDEFINED, WINDOW_SIZE, WINDOW_SIZE,
-                              SDL_WINDOW_SHOWN);
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
 
     if (!window) {
         printf("Error creating SDL window: %s\n", SDL_GetError());
         return false;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1,
+                                  SDL_RENDERER_ACCELERATED |
+                                      SDL_RENDERER_TARGETTEXTURE |
+                                      SDL_RENDERER_PRESENTVSYNC);
 
     if (!renderer) {
         printf("Error creating SDL renderer: %s\n", SDL_GetError());
         return false;
     }
 
+    SDL_RendererInfo info;
+    vsync = SDL_GetRendererInfo(renderer, &info) == 0 &&
+            (info.flags & SDL_RENDERER_PRESENTVSYNC);
+
+    int width, height;
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    if (!view_create(&view, renderer, &ctx, width, height)) {
+        printf("Error allocating the view\n");
+        return false;
+    }
+
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     SDL_RenderClear(renderer);
 
@@ -412,6 +411,7 @@ bool window_init() {
 }
 
 void window_kill() {
+    view_destroy(&view);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
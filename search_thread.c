@@ -0,0 +1,126 @@
+#include "search_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Move the changes logged by the search into the ring and publish them,
+// waiting for the viewer while the ring is full
+static void hand_over(SearchThread_Typedef* search) {
+    StateChanges_Typedef* changes = &search->changes;
+    int head = SDL_AtomicGet(&search->head);
+    for (int i = 0; i < changes->count; i++) {
+        int next = (head + 1) & (SEARCH_RING_SIZE - 1);
+        while (next == search->tail_seen) {
+            // Full, let the viewer have what's there and wait for room
+            SDL_AtomicSet(&search->head, head);
+            search->tail_seen = SDL_AtomicGet(&search->tail);
+            if (next != search->tail_seen) break;
+            if (SDL_AtomicGet(&search->stopping)) return;
+            SDL_Delay(1);
+        }
+        CellPosition_Typedef position =
+            astar_cell_position(search->ctx, changes->cells[i]);
+        search->ring[head] = (CellChange_Typedef){
+            .id = changes->cells[i],
+            .state = astar_cell_state(search->ctx, position.x, position.y)};
+        head = next;
+    }
+    changes->count = 0;
+    if (changes->overflowed) {
+        search->overflowed = true;
+        changes->overflowed = false;
+    }
+    SDL_AtomicSet(&search->head, head);
+}
+
+// Search thread, runs until the search ends or is stopped
+static int search_main(void* data) {
+    SearchThread_Typedef* search = data;
+    AStarContext_Typedef* ctx = search->ctx;
+    int frame = SDL_AtomicGet(&search->frame);
+    int left = search->expansions_per_frame;  // Expansions left this frame
+
+    while (ctx->status == SEARCH_RUNNING &&
+           !SDL_AtomicGet(&search->stopping)) {
+        int steps = SEARCH_CHUNK;
+        if (search->expansions_per_frame > 0) {
+            if (left == 0) {
+                // Wait for the next frame
+                if (SDL_AtomicGet(&search->frame) == frame) {
+                    SDL_Delay(1);
+                    continue;
+                }
+                frame = SDL_AtomicGet(&search->frame);
+                left = search->expansions_per_frame;
+            }
+            if (left < steps) steps = left;
+            left -= steps;
+        }
+
+        uint64_t begin = SDL_GetPerformanceCounter();
+        astar_run(ctx, steps);
+        search->search_ticks += SDL_GetPerformanceCounter() - begin;
+        hand_over(search);
+    }
+
+    SDL_AtomicSet(&search->finished, 1);
+    return 0;
+}
+
+bool search_thread_start(SearchThread_Typedef* search,
+                         AStarContext_Typedef* ctx, int expansions_per_frame) {
+    memset(search, 0, sizeof(*search));
+    search->ctx = ctx;
+    search->expansions_per_frame = expansions_per_frame;
+    // A chunk changes at most 9 cells per expansion (more only when a path
+    // is filled in at the end, which is caught by overflowed)
+    search->changes.capacity = SEARCH_CHUNK * (NEIGHBOURS_COUNT + 1);
+    search->changes.cells =
+        malloc(search->changes.capacity * sizeof(*search->changes.cells));
+    search->ring = malloc(SEARCH_RING_SIZE * sizeof(*search->ring));
+    if (!search->changes.cells || !search->ring) {
+        search_thread_stop(search);
+        return false;
+    }
+    ctx->changes = &search->changes;
+
+    search->thread = SDL_CreateThread(search_main, "search", search);
+    if (!search->thread) {
+        ctx->changes = NULL;
+        search_thread_stop(search);
+        return false;
+    }
+    return true;
+}
+
+void search_thread_stop(SearchThread_Typedef* search) {
+    if (search->thread) {
+        SDL_AtomicSet(&search->stopping, 1);
+        SDL_WaitThread(search->thread, NULL);
+        search->ctx->changes = NULL;
+    }
+    free(search->changes.cells);
+    free(search->ring);
+    memset(search, 0, sizeof(*search));
+}
+
+int search_thread_take(SearchThread_Typedef* search,
+                       const CellChange_Typedef** changes) {
+    int head = SDL_AtomicGet(&search->head);
+    int tail = SDL_AtomicGet(&search->tail);
+    *changes = &search->ring[tail];
+    return (head >= tail ? head : SEARCH_RING_SIZE) - tail;
+}
+
+void search_thread_release(SearchThread_Typedef* search, int count) {
+    int tail = SDL_AtomicGet(&search->tail);
+    SDL_AtomicSet(&search->tail, (tail + count) & (SEARCH_RING_SIZE - 1));
+}
+
+void search_thread_frame(SearchThread_Typedef* search) {
+    SDL_AtomicAdd(&search->frame, 1);
+}
+
+bool search_thread_finished(SearchThread_Typedef* search) {
+    return SDL_AtomicGet(&search->finished) != 0;
+}
@@ -0,0 +1,68 @@
+#ifndef SEARCH_THREAD_H
+#define SEARCH_THREAD_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astar.h"
+
+// Changes the ring holds (a power of two), the search waits for the viewer
+// when it is full
+#define SEARCH_RING_SIZE (1 << 20)
+// Most expansions between handing changes over
+#define SEARCH_CHUNK 64
+
+// New display state of a cell, handed from the search to the viewer
+typedef struct {
+    int32_t id;
+    uint8_t state;  // CellState_Typedef
+} CellChange_Typedef;
+
+// A search running on its own thread, flat out or a number of expansions
+// per frame, while the viewer draws at display rate. The cells it changes go
+// through a single producer, single consumer ring, so neither side locks or
+// waits for the other (unless the ring fills up). The viewer must not touch
+// the context until search_thread_finished
+typedef struct {
+    AStarContext_Typedef* ctx;  // Not owned
+    int expansions_per_frame;   // 0 runs flat out
+    StateChanges_Typedef changes;  // Logged by the search between handovers
+    CellChange_Typedef* ring;
+    SDL_atomic_t head;  // Next entry the search writes
+    SDL_atomic_t tail;  // Next entry the viewer reads
+    int tail_seen;      // Search thread's copy of tail
+    SDL_atomic_t frame;     // Frames drawn, paces the search
+    SDL_atomic_t stopping;  // Set by the viewer to end the search early
+    SDL_atomic_t finished;  // Set once the context is the viewer's again
+    // Only valid once finished
+    bool overflowed;        // Changes went unlogged, redraw everything
+    uint64_t search_ticks;  // Time in the search (performance counter ticks)
+    SDL_Thread* thread;
+} SearchThread_Typedef;
+
+// Run a search set up with astar_begin on a new thread. The viewer should
+// have drawn every cell before the thread starts
+bool search_thread_start(SearchThread_Typedef* search,
+                         AStarContext_Typedef* ctx, int expansions_per_frame);
+
+// Stop the search (if still running), wait for the thread and free the ring
+void search_thread_stop(SearchThread_Typedef* search);
+
+// Changes published so far, as one run of the ring from *changes. Returns
+// the number of changes, to be handed back with search_thread_release once
+// drawn (the ring may wrap, so take again until it returns 0)
+int search_thread_take(SearchThread_Typedef* search,
+                       const CellChange_Typedef** changes);
+
+// Hand back the changes of the last search_thread_take
+void search_thread_release(SearchThread_Typedef* search, int count);
+
+// Let a search paced by frames carry on for another frame
+void search_thread_frame(SearchThread_Typedef* search);
+
+// Check if the search has ended. Changes still in the ring should be taken
+// after this returns true, then the context may be used again
+bool search_thread_finished(SearchThread_Typedef* search);
+
+#endif  // SEARCH_THREAD_H
@@ -0,0 +1,423 @@
+#include "view.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest cells (pixels) drawn with grid lines, below that the lines would
+// hide the cells
+#define GRID_MIN_CELL_SIZE 4
+
+// Importance of each cell state when cells are summed up, a texel shows the
+// highest ranked state among its cells
+static const uint8_t state_rank[] = {
+    [CELL_EMPTY] = 0,     [CELL_BARRIER] = 1, [CELL_VISITED] = 2,
+    [CELL_NEIGHBOUR] = 3, [CELL_PATH] = 4,    [CELL_START] = 5,
+    [CELL_TARGET] = 6};
+
+// Colour of each rank (ARGB)
+static const uint32_t rank_colour[] = {
+    0xFFFFFFFF,  // Empty
+    0xFF000000,  // Barrier
+    0xFF00B400,  // Visited
+    0xFFFFEA00,  // Neighbour
+    0xFFFF3200,  // Path
+    0xFF0000FF,  // Start
+    0xFFFF0000   // Target
+};
+
+// Rank of a texel worked out from the 2x2 texels under it
+static uint8_t summarise(const ViewLevel_Typedef* below, int x, int y) {
+    uint8_t rank = 0;
+    for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+            int bx = 2 * x + dx, by = 2 * y + dy;
+            if (bx >= below->width || by >= below->height) continue;
+            uint8_t r = below->ranks[by * below->width + bx];
+            if (r > rank) rank = r;
+        }
+    }
+    return rank;
+}
+
+// Texels of a tile, less than VIEW_TILE_SIZE along the right and bottom
+// edges of the level
+static SDL_Rect tile_extent(const ViewLevel_Typedef* level, int tile) {
+    int tx = tile % level->tiles_x, ty = tile / level->tiles_x;
+    SDL_Rect extent = {.w = level->width - tx * VIEW_TILE_SIZE,
+                       .h = level->height - ty * VIEW_TILE_SIZE};
+    if (extent.w > VIEW_TILE_SIZE) extent.w = VIEW_TILE_SIZE;
+    if (extent.h > VIEW_TILE_SIZE) extent.h = VIEW_TILE_SIZE;
+    return extent;
+}
+
+// Grow the dirty rectangle of a texel's tile to take it in
+static void mark_dirty(ViewLevel_Typedef* level, int x, int y) {
+    int tile = y / VIEW_TILE_SIZE * level->tiles_x + x / VIEW_TILE_SIZE;
+    SDL_Rect* dirty = &level->tile_dirty[tile];
+    x %= VIEW_TILE_SIZE;
+    y %= VIEW_TILE_SIZE;
+    if (dirty->w == 0) {
+        *dirty = (SDL_Rect){.x = x, .y = y, .w = 1, .h = 1};
+        return;
+    }
+    int right = dirty->x + dirty->w, bottom = dirty->y + dirty->h;
+    if (x < dirty->x) dirty->x = x;
+    if (y < dirty->y) dirty->y = y;
+    if (x >= right) right = x + 1;
+    if (y >= bottom) bottom = y + 1;
+    dirty->w = right - dirty->x;
+    dirty->h = bottom - dirty->y;
+}
+
+// Mark every texel of a level changed
+static void mark_all_dirty(ViewLevel_Typedef* level) {
+    for (int t = 0; t < level->tiles_x * level->tiles_y; t++) {
+        level->tile_dirty[t] = tile_extent(level, t);
+    }
+}
+
+bool view_create(View_Typedef* view, SDL_Renderer* renderer,
+                 const AStarContext_Typedef* ctx, int window_width,
+                 int window_height) {
+    memset(view, 0, sizeof(*view));
+    view->ctx = ctx;
+    view->renderer = renderer;
+    view->window_width = window_width;
+    view->window_height = window_height;
+
+    // Halve the map until it fits in a single tile
+    int width = ctx->map->width, height = ctx->map->height;
+    view->level_count = 1;
+    while (width > VIEW_TILE_SIZE || height > VIEW_TILE_SIZE) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        view->level_count++;
+    }
+    view->levels = calloc(view->level_count, sizeof(*view->levels));
+    view->tile_pixels =
+        malloc(VIEW_TILE_SIZE * VIEW_TILE_SIZE * sizeof(*view->tile_pixels));
+    if (!view->levels || !view->tile_pixels) {
+        view_destroy(view);
+        return false;
+    }
+
+    width = ctx->map->width;
+    height = ctx->map->height;
+    for (int l = 0; l < view->level_count; l++) {
+        ViewLevel_Typedef* level = &view->levels[l];
+        level->width = width;
+        level->height = height;
+        level->tiles_x = (width + VIEW_TILE_SIZE - 1) / VIEW_TILE_SIZE;
+        level->tiles_y = (height + VIEW_TILE_SIZE - 1) / VIEW_TILE_SIZE;
+        int tile_count = level->tiles_x * level->tiles_y;
+        level->ranks = calloc((size_t)width * height, sizeof(*level->ranks));
+        level->tiles = calloc(tile_count, sizeof(*level->tiles));
+        level->tile_dirty = calloc(tile_count, sizeof(*level->tile_dirty));
+        level->tile_used = calloc(tile_count, sizeof(*level->tile_used));
+        if (!level->ranks || !level->tiles || !level->tile_dirty ||
+            !level->tile_used) {
+            view_destroy(view);
+            return false;
+        }
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+
+    view_fit(view);
+    return true;
+}
+
+void view_destroy(View_Typedef* view) {
+    for (int l = 0; view->levels && l < view->level_count; l++) {
+        ViewLevel_Typedef* level = &view->levels[l];
+        for (int t = 0; level->tiles && t < level->tiles_x * level->tiles_y;
+             t++) {
+            if (level->tiles[t]) SDL_DestroyTexture(level->tiles[t]);
+        }
+        free(level->ranks);
+        free(level->tiles);
+        free(level->tile_dirty);
+        free(level->tile_used);
+    }
+    free(view->levels);
+    free(view->tile_pixels);
+    if (view->grid) SDL_DestroyTexture(view->grid);
+    memset(view, 0, sizeof(*view));
+}
+
+void view_refresh_cell(View_Typedef* view, int32_t id) {
+    CellPosition_Typedef position = astar_cell_position(view->ctx, id);
+    view_set_cell(view, id,
+                  astar_cell_state(view->ctx, position.x, position.y));
+}
+
+void view_set_cell(View_Typedef* view, int32_t id, CellState_Typedef state) {
+    CellPosition_Typedef position = astar_cell_position(view->ctx, id);
+    int x = position.x, y = position.y;
+    uint8_t rank = state_rank[state];
+    if (view->levels[0].ranks[id] == rank) return;
+    view->levels[0].ranks[id] = rank;
+    mark_dirty(&view->levels[0], x, y);
+
+    // Carry the change up the levels for as long as it shows
+    for (int l = 1; l < view->level_count; l++) {
+        ViewLevel_Typedef* level = &view->levels[l];
+        x /= 2;
+        y /= 2;
+        rank = summarise(&view->levels[l - 1], x, y);
+        uint8_t* texel = &level->ranks[y * level->width + x];
+        if (*texel == rank) break;
+        *texel = rank;
+        mark_dirty(level, x, y);
+    }
+}
+
+void view_refresh_all(View_Typedef* view) {
+    ViewLevel_Typedef* cells = &view->levels[0];
+    for (int y = 0; y < cells->height; y++) {
+        for (int x = 0; x < cells->width; x++) {
+            cells->ranks[y * cells->width + x] =
+                state_rank[astar_cell_state(view->ctx, x, y)];
+        }
+    }
+    for (int l = 1; l < view->level_count; l++) {
+        ViewLevel_Typedef* level = &view->levels[l];
+        for (int y = 0; y < level->height; y++) {
+            for (int x = 0; x < level->width; x++) {
+                level->ranks[y * level->width + x] =
+                    summarise(&view->levels[l - 1], x, y);
+            }
+        }
+    }
+    for (int l = 0; l < view->level_count; l++) {
+        mark_all_dirty(&view->levels[l]);
+    }
+}
+
+// Size of a cell on screen (pixels, under 1 for levels above 0)
+static double scale(const View_Typedef* view) {
+    return (double)view->cell_size / (1 << view->level);
+}
+
+// Pixels from the left (top) edge of the map to the left (top) of the window.
+// The centre is never negative, so truncating rounds down
+static int origin_x(const View_Typedef* view) {
+    return (int)(view->centre_x * scale(view)) - view->window_width / 2;
+}
+static int origin_y(const View_Typedef* view) {
+    return (int)(view->centre_y * scale(view)) - view->window_height / 2;
+}
+
+// Keep the middle of the window on the map
+static void clamp_centre(View_Typedef* view) {
+    const Map_Typedef* map = view->ctx->map;
+    if (view->centre_x < 0) view->centre_x = 0;
+    if (view->centre_x > map->width) view->centre_x = map->width;
+    if (view->centre_y < 0) view->centre_y = 0;
+    if (view->centre_y > map->height) view->centre_y = map->height;
+}
+
+void view_fit(View_Typedef* view) {
+    const Map_Typedef* map = view->ctx->map;
+    int window = view->window_width < view->window_height
+                     ? view->window_width
+                     : view->window_height;
+    view->level = 0;
+    view->cell_size = window / (map->width > map->height ? map->width
+                                                         : map->height);
+    if (view->cell_size > VIEW_MAX_CELL_SIZE) {
+        view->cell_size = VIEW_MAX_CELL_SIZE;
+    }
+    if (view->cell_size < 1) {
+        // More cells than pixels, find the level that fits
+        view->cell_size = 1;
+        while (view->level + 1 < view->level_count &&
+               (view->levels[view->level].width > window ||
+                view->levels[view->level].height > window)) {
+            view->level++;
+        }
+    }
+    view->centre_x = map->width / 2.0;
+    view->centre_y = map->height / 2.0;
+}
+
+void view_zoom(View_Typedef* view, int steps, int x, int y) {
+    // Map position under the pixel, which should stay there
+    double map_x = (x + origin_x(view)) / scale(view);
+    double map_y = (y + origin_y(view)) / scale(view);
+
+    // Zoomed out, each step halves the texels drawn. Zoomed in, it doubles
+    // the size of cells
+    for (; steps > 0; steps--) {
+        if (view->level > 0) {
+            view->level--;
+        } else if (view->cell_size * 2 <= VIEW_MAX_CELL_SIZE) {
+            view->cell_size *= 2;
+        }
+    }
+    for (; steps < 0; steps++) {
+        if (view->cell_size > 1) {
+            view->cell_size /= 2;
+        } else if (view->level + 1 < view->level_count) {
+            view->level++;
+        }
+    }
+
+    view->centre_x = map_x + (view->window_width / 2 - x) / scale(view);
+    view->centre_y = map_y + (view->window_height / 2 - y) / scale(view);
+    clamp_centre(view);
+}
+
+void view_pan(View_Typedef* view, int dx, int dy) {
+    view->centre_x -= dx / scale(view);
+    view->centre_y -= dy / scale(view);
+    clamp_centre(view);
+}
+
+void view_resize(View_Typedef* view, int window_width, int window_height) {
+    view->window_width = window_width;
+    view->window_height = window_height;
+}
+
+// Copy the changed ranks of a tile into its texture
+static void upload_tile(View_Typedef* view, ViewLevel_Typedef* level,
+                        int tile) {
+    SDL_Rect* dirty = &level->tile_dirty[tile];
+    int tx = tile % level->tiles_x, ty = tile / level->tiles_x;
+    for (int y = 0; y < dirty->h; y++) {
+        const uint8_t* ranks =
+            &level->ranks[(ty * VIEW_TILE_SIZE + dirty->y + y) * level->width +
+                          tx * VIEW_TILE_SIZE + dirty->x];
+        for (int x = 0; x < dirty->w; x++) {
+            view->tile_pixels[y * dirty->w + x] = rank_colour[ranks[x]];
+        }
+    }
+    SDL_UpdateTexture(level->tiles[tile], dirty, view->tile_pixels,
+                      dirty->w * sizeof(*view->tile_pixels));
+    dirty->w = dirty->h = 0;
+}
+
+// Free the textures of the least recently drawn tiles (never of those drawn
+// this frame) until no more than VIEW_TEXTURE_CACHE are left
+static void evict_tiles(View_Typedef* view) {
+    while (view->texture_count > VIEW_TEXTURE_CACHE) {
+        ViewLevel_Typedef* oldest_level = NULL;
+        int oldest = -1;
+        for (int l = 0; l < view->level_count; l++) {
+            ViewLevel_Typedef* level = &view->levels[l];
+            for (int t = 0; t < level->tiles_x * level->tiles_y; t++) {
+                if (!level->tiles[t] || level->tile_used[t] == view->frame) {
+                    continue;
+                }
+                if (oldest < 0 ||
+                    level->tile_used[t] < oldest_level->tile_used[oldest]) {
+                    oldest_level = level;
+                    oldest = t;
+                }
+            }
+        }
+        if (oldest < 0) return;  // All on screen
+        SDL_DestroyTexture(oldest_level->tiles[oldest]);
+        oldest_level->tiles[oldest] = NULL;
+        view->texture_count--;
+    }
+}
+
+// Draw the tiles of the current level that are in the window
+static void draw_tiles(View_Typedef* view, int left, int top) {
+    view->frame++;
+    ViewLevel_Typedef* level = &view->levels[view->level];
+    for (int tile = 0; tile < level->tiles_x * level->tiles_y; tile++) {
+        int tx = tile % level->tiles_x, ty = tile / level->tiles_x;
+        SDL_Rect extent = tile_extent(level, tile);
+        SDL_Rect screen = {.x = left + tx * VIEW_TILE_SIZE * view->cell_size,
+                           .y = top + ty * VIEW_TILE_SIZE * view->cell_size,
+                           .w = extent.w * view->cell_size,
+                           .h = extent.h * view->cell_size};
+        if (screen.x >= view->window_width ||
+            screen.y >= view->window_height || screen.x + screen.w <= 0 ||
+            screen.y + screen.h <= 0) {
+            continue;
+        }
+
+        if (!level->tiles[tile]) {
+            level->tiles[tile] = SDL_CreateTexture(
+                view->renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_STREAMING, extent.w, extent.h);
+            if (!level->tiles[tile]) continue;
+            view->texture_count++;
+            level->tile_dirty[tile] = extent;
+        }
+        if (level->tile_dirty[tile].w > 0) {
+            upload_tile(view, level, tile);
+        }
+        level->tile_used[tile] = view->frame;
+        SDL_RenderCopy(view->renderer, level->tiles[tile], NULL, &screen);
+    }
+    evict_tiles(view);
+}
+
+// Draw the grid lines into view->grid, a window and a cell larger than the
+// window so it can be shifted by part of a cell as the map is panned
+static bool render_grid(View_Typedef* view) {
+    if (view->grid) SDL_DestroyTexture(view->grid);
+    int size = view->cell_size;
+    int width = view->window_width + size, height = view->window_height + size;
+    view->grid = SDL_CreateTexture(view->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                   SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!view->grid) return false;
+    SDL_SetTextureBlendMode(view->grid, SDL_BLENDMODE_BLEND);
+
+    // Transparent apart from the lines
+    SDL_SetRenderTarget(view->renderer, view->grid);
+    SDL_SetRenderDrawColor(view->renderer, 0, 0, 0, 0);
+    SDL_RenderClear(view->renderer);
+    SDL_SetRenderDrawColor(view->renderer, 100, 100, 100, 255);
+    for (int x = 0; x < width; x += size) {
+        SDL_RenderDrawLine(view->renderer, x, 0, x, height);
+    }
+    for (int y = 0; y < height; y += size) {
+        SDL_RenderDrawLine(view->renderer, 0, y, width, y);
+    }
+    SDL_SetRenderTarget(view->renderer, NULL);
+
+    view->grid_cell_size = size;
+    view->grid_width = view->window_width;
+    view->grid_height = view->window_height;
+    return true;
+}
+
+// Draw the grid lines over the part of the map in the window
+static void draw_grid(View_Typedef* view, int left, int top) {
+    if (view->level > 0 || view->cell_size < GRID_MIN_CELL_SIZE) return;
+    if (!view->grid || view->grid_cell_size != view->cell_size ||
+        view->grid_width != view->window_width ||
+        view->grid_height != view->window_height) {
+        if (!render_grid(view)) return;  // No render targets, no grid
+    }
+
+    const Map_Typedef* map = view->ctx->map;
+    SDL_Rect screen = {.x = left > 0 ? left : 0, .y = top > 0 ? top : 0};
+    int right = left + map->width * view->cell_size;
+    int bottom = top + map->height * view->cell_size;
+    screen.w = (right < view->window_width ? right : view->window_width) -
+               screen.x;
+    screen.h = (bottom < view->window_height ? bottom : view->window_height) -
+               screen.y;
+    if (screen.w <= 0 || screen.h <= 0) return;
+
+    // Lines of the texture fall every cell_size texels from 0, shift them
+    // onto the cell edges
+    int size = view->cell_size;
+    SDL_Rect lines = {.x = ((screen.x - left) % size + size) % size,
+                      .y = ((screen.y - top) % size + size) % size,
+                      .w = screen.w,
+                      .h = screen.h};
+    SDL_RenderCopy(view->renderer, view->grid, &lines, &screen);
+}
+
+void view_draw(View_Typedef* view) {
+    int left = -origin_x(view), top = -origin_y(view);
+    draw_tiles(view, left, top);
+    draw_grid(view, left, top);
+}
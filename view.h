@@ -0,0 +1,100 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "astar.h"
+
+// Texels along each side of a tile texture
+#define VIEW_TILE_SIZE 512
+// Largest cell on screen (pixels)
+#define VIEW_MAX_CELL_SIZE 64
+// Tile textures kept (1 MiB each at most), the least recently drawn are
+// freed beyond that
+#define VIEW_TEXTURE_CACHE 64
+
+// The map at one level of detail. Each texel sums up a square of 2^level
+// cells by showing the most important state among them, so paths and the
+// search frontier stay visible however far out the view is zoomed
+typedef struct {
+    int width;  // Texels
+    int height;
+    uint8_t* ranks;  // Rank (see view.c) of each texel, row by row
+    // Textures of VIEW_TILE_SIZE texels square, created when first drawn and
+    // kept while recently used (see VIEW_TEXTURE_CACHE)
+    int tiles_x;
+    int tiles_y;
+    SDL_Texture** tiles;
+    // Texels of each tile (from its corner) changed since it was uploaded,
+    // none if the width is 0
+    SDL_Rect* tile_dirty;
+    uint32_t* tile_used;  // Frame each tile was last drawn in
+} ViewLevel_Typedef;
+
+// Zoomable, pannable picture of a search. Only the tiles inside the window
+// are drawn, from the level of detail that puts about one texel on each
+// pixel once zoomed out
+typedef struct {
+    const AStarContext_Typedef* ctx;  // Not owned
+    SDL_Renderer* renderer;           // Not owned
+    ViewLevel_Typedef* levels;  // levels[0] has one texel per cell
+    int level_count;
+    uint32_t* tile_pixels;  // Colours of a tile being uploaded
+    int texture_count;      // Tile textures alive
+    uint32_t frame;         // Frames drawn
+    // Camera: the level drawn, the size of its texels on screen (only level
+    // 0 is ever drawn with texels over 1 pixel) and the map position (cells)
+    // at the middle of the window
+    int level;
+    int cell_size;
+    double centre_x;
+    double centre_y;
+    int window_width;
+    int window_height;
+    // Grid lines, drawn once for the cell size and window and reused
+    SDL_Texture* grid;
+    int grid_cell_size;
+    int grid_width;
+    int grid_height;
+} View_Typedef;
+
+// Allocate the levels of detail for the map of a search and fit the map in
+// the window. Every cell starts empty, call view_refresh_all once the search
+// has begun
+bool view_create(View_Typedef* view, SDL_Renderer* renderer,
+                 const AStarContext_Typedef* ctx, int window_width,
+                 int window_height);
+
+// Free the levels and textures of a view
+void view_destroy(View_Typedef* view);
+
+// Pick up the state of one cell after the search changed it
+void view_refresh_cell(View_Typedef* view, int32_t id);
+
+// Show a cell in a state, for a search the view can't read from (one running
+// on another thread)
+void view_set_cell(View_Typedef* view, int32_t id, CellState_Typedef state);
+
+// Pick up the state of every cell
+void view_refresh_all(View_Typedef* view);
+
+// Zoom so the whole map fits in the window
+void view_fit(View_Typedef* view);
+
+// Zoom in (steps > 0) or out, keeping the map under window pixel (x, y)
+// where it is
+void view_zoom(View_Typedef* view, int steps, int x, int y);
+
+// Move the map by (dx, dy) pixels
+void view_pan(View_Typedef* view, int dx, int dy);
+
+// Follow a change of window size
+void view_resize(View_Typedef* view, int window_width, int window_height);
+
+// Draw the visible part of the map (and grid lines when cells are large
+// enough to show them)
+void view_draw(View_Typedef* view);
+
+#endif  // VIEW_H